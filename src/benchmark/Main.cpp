@@ -0,0 +1,501 @@
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+#include "SpectralMorph.h"
+#include "SimdKernels.h"
+#include "PolyphaseResampler.h"
+#include "LevelMeter.h"
+
+/**
+ * Compares the partitioned convolver, once per SIMD kernel set, against
+ * juce::dsp::Convolution on synthetic IRs from 0.5 s to 14 s, the level meter
+ * against separate JUCE passes, then the IR resampler presets against
+ * juce::LagrangeInterpolator. Along the way it checks the partition layouts and
+ * that a bounce split across worker threads matches a single run, and exits with
+ * 1 if either fails.
+ *
+ * Usage: CanDamoniumBenchmark [blockSize] [secondsOfAudio]
+ */
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int maxPartitionSize = 8192;
+    constexpr int warmUpBlocks = 64;
+    constexpr int offlineBlockSize = 8192;
+    constexpr int minWorkerBlockSize = 1024;   // The smallest block the plugin hands to worker threads
+    constexpr int numOfflineCheckRuns = 4;
+    constexpr double maxOfflineError = 1.0e-5;
+
+    // Exponentially decaying noise, roughly what a room or cab tail looks like
+    juce::AudioBuffer<float> makeImpulseResponse (double seconds)
+    {
+        const int length = (int) (seconds * sampleRate);
+        juce::AudioBuffer<float> ir (numChannels, length);
+        juce::Random random (1234);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = ir.getWritePointer (ch);
+            for (int i = 0; i < length; ++i)
+                data[i] = (random.nextFloat() * 2.0f - 1.0f) * std::exp (-6.9f * (float) i / (float) length);
+        }
+
+        ir.applyGain (0.1f / std::sqrt ((float) length));
+        return ir;
+    }
+
+    juce::AudioBuffer<float> makeInput (int numSamples)
+    {
+        juce::AudioBuffer<float> input (numChannels, numSamples);
+        juce::Random random (42);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        return input;
+    }
+
+    // The input with only the first second of every four left playing, as between phrases
+    juce::AudioBuffer<float> makeGatedInput (const juce::AudioBuffer<float>& input)
+    {
+        juce::AudioBuffer<float> gated;
+        gated.makeCopyOf (input);
+        const int period = (int) (4.0 * sampleRate);
+
+        for (int start = (int) sampleRate; start < gated.getNumSamples(); start += period)
+            gated.clear (start, juce::jmin (period - (int) sampleRate, gated.getNumSamples() - start));
+
+        return gated;
+    }
+
+    // Runs processBlock over the input in blockSize chunks, returns seconds spent after warm-up
+    template <typename SampleType = float, typename ProcessBlock>
+    double timeBlocks (const juce::AudioBuffer<float>& input, int blockSize, ProcessBlock&& processBlock)
+    {
+        juce::AudioBuffer<SampleType> block (numChannels, blockSize);
+        double seconds = 0.0;
+        const int numBlocks = input.getNumSamples() / blockSize;
+
+        for (int b = 0; b < numBlocks + warmUpBlocks; ++b)
+        {
+            const int start = (b % numBlocks) * blockSize;
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy_n (input.getReadPointer (ch, start), blockSize, block.getWritePointer (ch));
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            processBlock (block);
+            const auto endTicks = juce::Time::getHighResolutionTicks();
+
+            if (b >= warmUpBlocks)
+                seconds += juce::Time::highResolutionTicksToSeconds (endTicks - startTicks);
+        }
+
+        return seconds;
+    }
+
+    double benchmarkJuce (const juce::AudioBuffer<float>& ir, const juce::AudioBuffer<float>& input, int blockSize)
+    {
+        juce::dsp::Convolution convolution;
+        convolution.prepare ({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+
+        juce::AudioBuffer<float> irCopy;
+        irCopy.makeCopyOf (ir);
+        convolution.loadImpulseResponse (std::move (irCopy), sampleRate,
+                                         juce::dsp::Convolution::Stereo::yes,
+                                         juce::dsp::Convolution::Trim::no,
+                                         juce::dsp::Convolution::Normalise::no);
+
+        // The IR is installed by a background thread and picked up on the next process call
+        juce::AudioBuffer<float> scratch (numChannels, blockSize);
+        for (int i = 0; i < 200 && convolution.getCurrentIRSize() != ir.getNumSamples(); ++i)
+        {
+            juce::dsp::AudioBlock<float> block (scratch);
+            convolution.process (juce::dsp::ProcessContextReplacing<float> (block));
+            juce::Thread::sleep (10);
+        }
+
+        return timeBlocks (input, blockSize, [&] (juce::AudioBuffer<float>& buffer)
+        {
+            juce::dsp::AudioBlock<float> block (buffer);
+            convolution.process (juce::dsp::ProcessContextReplacing<float> (block));
+        });
+    }
+
+    // With trueStereo set, each input reaches both outputs (four paths sharing two forward FFTs).
+    // numBlendedIRs > 1 mixes that many copies of the IR through separate gain groups.
+    // SampleType is what the host hands over; the spectra are float either way.
+    template <typename SampleType = float>
+    double benchmarkPartitioned (const SimdKernels::KernelTable& kernels, const juce::AudioBuffer<float>& ir,
+                                 const juce::AudioBuffer<float>& input, int blockSize, bool trueStereo = false,
+                                 int numBlendedIRs = 1)
+    {
+        const auto layout = PartitionLayout::createNonUniform (ir.getNumSamples(), blockSize, maxPartitionSize, blockSize);
+
+        PartitionedConvolver convolver (kernels);
+        convolver.prepare (layout, numChannels, numChannels, blockSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto channelIR = std::make_shared<const PartitionedIR> (layout, ir.getReadPointer (ch), ir.getNumSamples());
+
+            for (int group = 0; group < numBlendedIRs; ++group)
+            {
+                convolver.addPath (ch, ch, channelIR, group);
+
+                if (trueStereo)
+                    convolver.addPath (ch, (ch + 1) % numChannels, channelIR, group);
+            }
+        }
+
+        for (int group = 0; group < numBlendedIRs; ++group)
+            convolver.setGain (group, 1.0f / (float) numBlendedIRs, false);
+
+        return timeBlocks<SampleType> (input, blockSize, [&] (juce::AudioBuffer<SampleType>& buffer)
+        {
+            convolver.process (buffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+        });
+    }
+
+    // The layout the plugin uses for bounces: uniform offlineBlockSize partitions in numRuns runs,
+    // all but the first handed to the pool if one is given
+    std::unique_ptr<PartitionedConvolver> createOfflineConvolver (const SimdKernels::KernelTable& kernels, const juce::AudioBuffer<float>& ir,
+                                                                  int numRuns, ConvolutionWorkerPool* pool)
+    {
+        const auto layout = PartitionLayout::createUniform (ir.getNumSamples(), offlineBlockSize, numRuns);
+
+        auto convolver = std::make_unique<PartitionedConvolver> (kernels);
+        if (pool != nullptr)
+            convolver->setScheduling (PartitionedConvolver::Scheduling::offlineWorkers, pool, offlineBlockSize);
+        convolver->prepare (layout, numChannels, numChannels, offlineBlockSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            convolver->addPath (ch, ch, std::make_shared<const PartitionedIR> (layout, ir.getReadPointer (ch), ir.getNumSamples()));
+
+        return convolver;
+    }
+
+    // The bounce layout with one run per worker thread plus one, still fed in blockSize chunks
+    double benchmarkOffline (const SimdKernels::KernelTable& kernels, const juce::AudioBuffer<float>& ir,
+                             const juce::AudioBuffer<float>& input, int blockSize, ConvolutionWorkerPool* pool)
+    {
+        auto convolver = createOfflineConvolver (kernels, ir, pool != nullptr ? pool->getNumThreads() + 1 : 1, pool);
+
+        return timeBlocks (input, blockSize, [&] (juce::AudioBuffer<float>& buffer)
+        {
+            convolver->process (buffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+        });
+    }
+
+    /** Regression check for bounces: runs handed to a pool must give the same output as one run
+        on the calling thread. The pool has no threads, so every task is still queued when the
+        next block arrives, the case that used to drop blocks, whatever the machine and timing.
+        Returns the RMS difference relative to the single run's output. */
+    double measureOfflineError (const SimdKernels::KernelTable& kernels, const juce::AudioBuffer<float>& ir,
+                                const juce::AudioBuffer<float>& input, int blockSize)
+    {
+        ConvolutionWorkerPool idlePool (0, numOfflineCheckRuns);
+        auto reference = createOfflineConvolver (kernels, ir, 1, nullptr);
+        auto threaded = createOfflineConvolver (kernels, ir, numOfflineCheckRuns, &idlePool);
+        juce::AudioBuffer<float> expected (numChannels, blockSize), actual (numChannels, blockSize);
+        double errorSquares = 0.0, signalSquares = 0.0;
+
+        for (int start = 0; start + blockSize <= input.getNumSamples(); start += blockSize)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                expected.copyFrom (ch, 0, input, ch, start, blockSize);
+                actual.copyFrom (ch, 0, input, ch, start, blockSize);
+            }
+
+            reference->process (expected.getArrayOfReadPointers(), expected.getArrayOfWritePointers(), numChannels, blockSize);
+            threaded->process (actual.getArrayOfReadPointers(), actual.getArrayOfWritePointers(), numChannels, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const double e = expected.getSample (ch, i), a = actual.getSample (ch, i);
+                    errorSquares += (a - e) * (a - e);
+                    signalSquares += e * e;
+                }
+            }
+        }
+
+        return std::sqrt (errorSquares / juce::jmax (signalSquares, 1.0e-30));
+    }
+
+    // Morphs between numIRs copies of the IR while the position sweeps back and forth
+    double benchmarkMorph (const SimdKernels::KernelTable& kernels, const juce::AudioBuffer<float>& ir,
+                           const juce::AudioBuffer<float>& input, int blockSize, int numIRs)
+    {
+        const auto layout = PartitionLayout::createNonUniform (ir.getNumSamples(), blockSize, maxPartitionSize, blockSize);
+
+        PartitionedConvolver convolver (kernels);
+        convolver.prepare (layout, numChannels, numChannels, blockSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto channelIR = std::make_shared<const PartitionedIR> (layout, ir.getReadPointer (ch), ir.getNumSamples());
+            std::vector<std::shared_ptr<const PartitionedIR>> sources ((size_t) numIRs, channelIR);
+            convolver.addPath (ch, ch, std::make_shared<SpectralMorph> (std::move (sources)));
+        }
+
+        int blockIndex = 0;
+
+        return timeBlocks (input, blockSize, [&] (juce::AudioBuffer<float>& buffer)
+        {
+            convolver.setMorphPosition (std::abs (std::fmod ((float) blockIndex++ * 0.01f, 2.0f) - 1.0f));
+            convolver.process (buffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+        });
+    }
+
+    // Level of one frequency in dB relative to a full-scale sine, Hann windowed
+    double measureToneDecibels (const std::vector<float>& signal, double frequency, double rate)
+    {
+        double re = 0.0, im = 0.0;
+        const auto length = signal.size();
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            const double window = 0.5 - 0.5 * std::cos (juce::MathConstants<double>::twoPi * (double) i / (double) length);
+            const double angle = juce::MathConstants<double>::twoPi * frequency * (double) i / rate;
+            re += window * signal[i] * std::cos (angle);
+            im += window * signal[i] * std::sin (angle);
+        }
+
+        return juce::Decibels::gainToDecibels (std::sqrt (re * re + im * im) / (0.25 * (double) length), -200.0);
+    }
+
+    // preset < 0 runs the Lagrange interpolator the engine used before the polyphase resampler
+    std::vector<float> resampleChannel (const float* input, int numSamples, double targetRate, int preset)
+    {
+        if (preset < 0)
+        {
+            std::vector<float> output ((size_t) std::ceil (numSamples * targetRate / sampleRate));
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process (sampleRate / targetRate, input, output.data(), (int) output.size());
+            return output;
+        }
+
+        const PolyphaseResampler resampler (sampleRate, targetRate, (PolyphaseResampler::Quality) preset);
+        std::vector<float> output ((size_t) resampler.getOutputLength (numSamples));
+        resampler.process (input, numSamples, output.data());
+        return output;
+    }
+
+    /** Time to resample the 14 s stereo IR (channels in parallel for the presets), and how far a
+        23 kHz tone is pushed down where it would fold back (downsampling) or image (upsampling). */
+    void benchmarkResampling (double targetRate)
+    {
+        const auto ir = makeImpulseResponse (14.0);
+        const int toneLength = (int) sampleRate;
+        std::vector<float> tone ((size_t) toneLength);
+
+        for (int i = 0; i < toneLength; ++i)
+            tone[(size_t) i] = (float) std::sin (juce::MathConstants<double>::twoPi * 23000.0 * i / sampleRate);
+
+        const double artefactFrequency = targetRate < sampleRate ? targetRate - 23000.0 : sampleRate - 23000.0;
+        std::cout << std::endl << "IR resampling 48000 -> " << targetRate << " Hz (14 s stereo)" << std::endl;
+
+        for (int preset = -1; preset <= (int) PolyphaseResampler::Quality::best; ++preset)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+
+            if (preset < 0)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    resampleChannel (ir.getReadPointer (ch), ir.getNumSamples(), targetRate, preset);
+            }
+            else
+            {
+                PolyphaseResampler::resample (ir, sampleRate, targetRate, (PolyphaseResampler::Quality) preset);
+            }
+
+            const double ms = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+            const auto resampledTone = resampleChannel (tone.data(), toneLength, targetRate, preset);
+            const auto name = preset < 0 ? juce::String ("Lagrange") : juce::String (PolyphaseResampler::getQualityName ((PolyphaseResampler::Quality) preset));
+
+            std::cout << "  " << name.paddedRight (' ', 13) << juce::String (ms, 1).paddedLeft (' ', 7) << " ms  "
+                      << (targetRate < sampleRate ? "alias " : "image ")
+                      << juce::String (measureToneDecibels (resampledTone, artefactFrequency, targetRate), 1) << " dB" << std::endl;
+        }
+    }
+
+    // Peak and RMS the way the processor used to take them (a pass each), or LevelMeter's single pass that adds true peak
+    double benchmarkMetering (const SimdKernels::KernelTable* kernels, const juce::AudioBuffer<float>& input, int blockSize)
+    {
+        LevelMeter meter (kernels != nullptr ? *kernels : SimdKernels::selectKernels());
+        meter.prepare (sampleRate);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+        float sink = 0.0f;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int start = 0; start + blockSize <= input.getNumSamples(); start += blockSize)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                block.copyFrom (ch, 0, input, ch, start, blockSize);
+
+            if (kernels == nullptr)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    sink += block.getRMSLevel (ch, 0, blockSize) + block.getMagnitude (ch, 0, blockSize);
+            }
+            else
+            {
+                sink += meter.measure (LevelMeter::Stage::output, block, numChannels).truePeak;
+                meter.publish (blockSize);
+            }
+        }
+
+        juce::ignoreUnused (sink);
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    /** Prints the non-uniform layouts for a few IR lengths and head sizes, on one thread and with
+        worker threads taking minWorkerBlockSize blocks, and checks that each one tiles the IR and
+        grows: with workers to their block size from 0.1 s, on one thread to 4096 for a 14 s tail. */
+    bool checkLayouts()
+    {
+        bool passed = true;
+        std::cout << std::endl << "Partition layouts (blocks x size)" << std::endl;
+
+        for (int offloadBlockSize : { 0, minWorkerBlockSize })
+        {
+            for (double irSeconds : { 0.05, 0.1, 0.5, 2.0, 14.0 })
+            {
+                for (int headBlockSize : { 64, 256, 1024 })
+                {
+                    const int irLength = (int) (irSeconds * sampleRate);
+                    const auto layout = PartitionLayout::createNonUniform (irLength, headBlockSize, maxPartitionSize,
+                                                                           headBlockSize, 0, offloadBlockSize);
+                    juce::String description;
+                    bool tiles = true;
+                    int end = 0;
+
+                    for (const auto& segment : layout.segments)
+                    {
+                        description << " " << segment.numPartitions << "x" << segment.blockSize;
+                        tiles = tiles && segment.offset == end;
+                        end = segment.offset + segment.numPartitions * segment.blockSize;
+                    }
+
+                    tiles = tiles && end >= irLength;
+                    const bool grows = offloadBlockSize > 0 ? irSeconds < 0.1 || layout.getMaxBlockSize() >= offloadBlockSize
+                                                            : irSeconds < 14.0 || layout.getMaxBlockSize() >= 4096;
+                    passed = passed && tiles && grows;
+
+                    std::cout << "  " << (offloadBlockSize > 0 ? "workers " : "1 thread ") << juce::String (irSeconds).paddedRight (' ', 5)
+                              << "s head " << juce::String (headBlockSize).paddedLeft (' ', 4)
+                              << ":" << description << (tiles && grows ? "" : "  FAILED") << std::endl;
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    juce::String formatResult (double seconds, double audioSeconds)
+    {
+        // CPU time per second of audio, and how many times faster than real time
+        return juce::String (seconds * 1000.0 / audioSeconds, 2) + " ms/s (x"
+             + juce::String (juce::roundToInt (audioSeconds / juce::jmax (seconds, 1.0e-9))) + ")";
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    const int blockSize = juce::jlimit (32, 4096, argc > 1 ? juce::String (argv[1]).getIntValue() : 256);
+    const double audioSeconds = juce::jlimit (1.0, 600.0, argc > 2 ? juce::String (argv[2]).getDoubleValue() : 10.0);
+
+    const auto input = makeInput ((int) (audioSeconds * sampleRate));
+    const auto gatedInput = makeGatedInput (input);
+    const double timedSeconds = (double) ((input.getNumSamples() / blockSize) * blockSize) / sampleRate;
+
+    std::vector<SimdKernels::KernelTable> kernelSets;
+    for (auto instructionSet : { SimdKernels::InstructionSet::scalar, SimdKernels::InstructionSet::sse2,
+                                 SimdKernels::InstructionSet::avx2, SimdKernels::InstructionSet::avx512 })
+        if (SimdKernels::isSupported (instructionSet))
+            kernelSets.push_back (SimdKernels::getKernels (instructionSet));
+
+    const int numOfflineWorkers = juce::jlimit (0, 4, juce::SystemStats::getNumPhysicalCpus() - 1);
+    std::unique_ptr<ConvolutionWorkerPool> offlinePool;
+    if (numOfflineWorkers > 0)
+        offlinePool = std::make_unique<ConvolutionWorkerPool> (numOfflineWorkers);
+
+    bool anyCheckFailed = ! checkLayouts();
+
+    std::cout << "Block size " << blockSize << ", " << audioSeconds << " s of stereo audio at "
+              << sampleRate << " Hz (selected kernels: " << SimdKernels::selectKernels().name << ")" << std::endl;
+
+    for (double irSeconds : { 0.5, 1.0, 2.0, 5.0, 10.0, 14.0 })
+    {
+        const auto ir = makeImpulseResponse (irSeconds);
+        const double juceSeconds = benchmarkJuce (ir, input, blockSize);
+
+        std::cout << std::endl << "IR " << irSeconds << " s" << std::endl;
+        std::cout << "  JUCE uniform   " << formatResult (juceSeconds, timedSeconds) << std::endl;
+
+        for (const auto& kernels : kernelSets)
+        {
+            const double seconds = benchmarkPartitioned (kernels, ir, input, blockSize);
+            std::cout << "  " << juce::String (kernels.name).paddedRight (' ', 15)
+                      << formatResult (seconds, timedSeconds)
+                      << "  speedup " << juce::String (juceSeconds / juce::jmax (seconds, 1.0e-9), 2) << std::endl;
+        }
+
+        const auto selected = SimdKernels::selectKernels();
+        const double stereoSeconds = benchmarkPartitioned (selected, ir, input, blockSize);
+        const double trueStereoSeconds = benchmarkPartitioned (selected, ir, input, blockSize, true);
+        std::cout << "  True stereo    " << formatResult (trueStereoSeconds, timedSeconds)
+                  << "  cost vs stereo " << juce::String (trueStereoSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+
+        const double blendSeconds = benchmarkPartitioned (selected, ir, input, blockSize, false, 3);
+        std::cout << "  Blend of 3     " << formatResult (blendSeconds, timedSeconds)
+                  << "  cost vs stereo " << juce::String (blendSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+
+        const double doubleSeconds = benchmarkPartitioned<double> (selected, ir, input, blockSize);
+        std::cout << "  Double I/O     " << formatResult (doubleSeconds, timedSeconds)
+                  << "  cost vs float " << juce::String (doubleSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+
+        const double morphSeconds = benchmarkMorph (selected, ir, input, blockSize, 3);
+        std::cout << "  Morph of 3     " << formatResult (morphSeconds, timedSeconds)
+                  << "  cost vs stereo " << juce::String (morphSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+
+        const double gatedSeconds = benchmarkPartitioned (selected, ir, gatedInput, blockSize);
+        std::cout << "  Gated input    " << formatResult (gatedSeconds, timedSeconds)
+                  << "  cost vs stereo " << juce::String (gatedSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+
+        const double offlineSeconds = benchmarkOffline (selected, ir, input, blockSize, nullptr);
+        std::cout << "  Offline        " << formatResult (offlineSeconds, timedSeconds)
+                  << "  cost vs stereo " << juce::String (offlineSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+
+        if (offlinePool != nullptr)
+        {
+            const double threadedSeconds = benchmarkOffline (selected, ir, input, blockSize, offlinePool.get());
+            std::cout << "  Offline " << numOfflineWorkers + 1 << " runs " << formatResult (threadedSeconds, timedSeconds)
+                      << "  cost vs stereo " << juce::String (threadedSeconds / juce::jmax (stereoSeconds, 1.0e-9), 2) << std::endl;
+        }
+
+        const double offlineError = measureOfflineError (selected, ir, input, blockSize);
+        std::cout << "  Offline check  " << numOfflineCheckRuns << " runs vs 1, relative error "
+                  << juce::String (offlineError, 9) << (offlineError < maxOfflineError ? "" : "  FAILED") << std::endl;
+        anyCheckFailed = anyCheckFailed || ! (offlineError < maxOfflineError);
+    }
+
+    std::cout << std::endl << "Metering (peak and RMS; LevelMeter adds true peak)" << std::endl;
+    const double separateSeconds = benchmarkMetering (nullptr, input, blockSize);
+    std::cout << "  Separate JUCE  " << formatResult (separateSeconds, timedSeconds) << std::endl;
+
+    for (const auto& kernels : kernelSets)
+    {
+        const double seconds = benchmarkMetering (&kernels, input, blockSize);
+        std::cout << "  " << juce::String (kernels.name).paddedRight (' ', 15) << formatResult (seconds, timedSeconds)
+                  << "  cost vs separate " << juce::String (seconds / juce::jmax (separateSeconds, 1.0e-9), 2) << std::endl;
+    }
+
+    for (double targetRate : { 44100.0, 88200.0, 96000.0, 192000.0 })
+        benchmarkResampling (targetRate);
+
+    return anyCheckFailed ? 1 : 0;
+}
@@ -23,6 +23,7 @@ constexpr int IR_BIT_DEPTH = 24;
 
 // Library paths
 constexpr const char* DEFAULT_LIBRARY_FOLDER = "Can_damonium/IRs";
+constexpr const char* DEFAULT_PARTITION_CACHE_FOLDER = "Can_damonium/PartitionCache";
 
 struct IRMetadata {
     std::string name;
@@ -0,0 +1,124 @@
+#include "AudioLogger.h"
+
+//==============================================================================
+class AudioLogger::Writer : private juce::Thread
+{
+public:
+    Writer()
+        : juce::Thread ("Audio log writer")
+    {
+        startThread (juce::Thread::Priority::low);
+    }
+
+    ~Writer() override
+    {
+        stopThread (1000);
+    }
+
+    void add (AudioLogger& logger)
+    {
+        const juce::ScopedLock sl (lock);
+        loggers.add (&logger);
+    }
+
+    // Whatever the logger still holds is written before it goes
+    void remove (AudioLogger& logger)
+    {
+        const juce::ScopedLock sl (lock);
+        logger.drain();
+        loggers.removeFirstMatchingValue (&logger);
+    }
+
+private:
+    void run() override
+    {
+        // Polls rather than being signalled, so the audio thread never touches a lock
+        while (! threadShouldExit())
+        {
+            {
+                const juce::ScopedLock sl (lock);
+
+                for (auto* logger : loggers)
+                    logger->drain();
+            }
+
+            wait (50);
+        }
+    }
+
+    juce::CriticalSection lock;
+    juce::Array<AudioLogger*> loggers;
+};
+
+//==============================================================================
+AudioLogger::AudioLogger()
+{
+    writer->add (*this);
+}
+
+AudioLogger::~AudioLogger()
+{
+    writer->remove (*this);
+}
+
+void AudioLogger::post (const char* text, std::initializer_list<double> values, const char* detail) noexcept
+{
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 == 0)
+    {
+        numDropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& record = records[(size_t) scope.startIndex1];
+    record.text = text;
+    record.numValues = 0;
+
+    for (const auto value : values)
+        if (record.numValues < maxValues)
+            record.values[(size_t) record.numValues++] = value;
+
+    int length = 0;
+
+    if (detail != nullptr)
+        for (; length < maxDetailLength && detail[length] != 0; ++length)
+            record.detail[length] = detail[length];
+
+    record.detail[length] = 0;
+}
+
+void AudioLogger::drain()
+{
+    const auto scope = fifo.read (fifo.getNumReady());
+    scope.forEach ([this] (int index) { juce::Logger::writeToLog (format (records[(size_t) index])); });
+
+    if (const auto dropped = numDropped.exchange (0, std::memory_order_relaxed); dropped > 0)
+        juce::Logger::writeToLog ("  (" + juce::String (dropped) + " audio thread log messages dropped)");
+}
+
+juce::String AudioLogger::format (const Record& record)
+{
+    juce::String line;
+    const char* start = record.text;
+    int valueIndex = 0;
+
+    for (const char* c = start; *c != 0; ++c)
+    {
+        if (c[0] != '{' || c[1] != '}' || valueIndex >= record.numValues)
+            continue;
+
+        // Counts print as integers, levels with four decimals
+        const auto value = record.values[(size_t) valueIndex++];
+        line << juce::String (start, (size_t) (c - start))
+             << (value == std::floor (value) && std::abs (value) < 1.0e15 ? juce::String ((juce::int64) value) : juce::String (value, 4));
+        start = ++c + 1;
+    }
+
+    line << start;
+
+    if (record.detail[0] != 0)
+        line << ": " << record.detail;
+
+    return line;
+}
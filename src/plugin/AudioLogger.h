@@ -0,0 +1,55 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/**
+ * Logging for the audio thread.
+ *
+ * post() copies a fixed-size record into a single-producer ring (juce::AbstractFifo)
+ * and returns: no allocation, no locks, no formatting. A shared background thread
+ * drains every logger's ring, fills in the values and hands the lines to
+ * juce::Logger::writeToLog, so they reach CanDamonium.log (or whatever logger the
+ * host app installed) in order, a few tens of milliseconds late.
+ *
+ * Each logger has one producer: give every object that logs from an audio callback
+ * its own. Records that find the ring full are counted and reported as dropped.
+ */
+class AudioLogger
+{
+public:
+    static constexpr int maxValues = 4;
+    static constexpr int maxDetailLength = 63;
+
+    AudioLogger();
+    ~AudioLogger();
+
+    /** Wait-free. text must outlive the logger (a string literal): each "{}" in it is replaced
+        by the next value. detail, if given, is copied and appended after a colon. */
+    void post (const char* text, std::initializer_list<double> values = {}, const char* detail = nullptr) noexcept;
+
+private:
+    class Writer;
+
+    struct Record
+    {
+        const char* text;
+        std::array<double, maxValues> values;
+        int numValues;
+        char detail[maxDetailLength + 1];
+    };
+
+    // Background thread only
+    void drain();
+    static juce::String format (const Record& record);
+
+    static constexpr int capacity = 256;
+    juce::AbstractFifo fifo { capacity };
+    std::array<Record, capacity> records {};
+    std::atomic<int> numDropped { 0 };
+
+    juce::SharedResourcePointer<Writer> writer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioLogger)
+};
@@ -1,89 +1,442 @@
 #include "ConvolutionEngine.h"
+#include "SpectralMorph.h"
+#include "IRProcessor.h"
 
 namespace
 {
-    juce::AudioBuffer<float> resampleIrBuffer(const juce::AudioBuffer<float>& input,
-                                              double sourceSampleRate,
-                                              double targetSampleRate)
+    // Same scaling as juce::dsp::Convolution::Normalise::yes so both algorithms match in level
+    void normaliseIrBuffer (juce::AudioBuffer<float>& buffer)
     {
-        const int inputSamples = input.getNumSamples();
-        const int channels = input.getNumChannels();
-        const double ratio = sourceSampleRate / targetSampleRate;
-        const int outputSamples = static_cast<int>(std::ceil(inputSamples / ratio));
+        float maxSumSquared = 0.0f;
 
-        juce::AudioBuffer<float> output(channels, outputSamples);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const auto* data = buffer.getReadPointer (ch);
+            float sumSquared = 0.0f;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                sumSquared += data[i] * data[i];
+
+            maxSumSquared = juce::jmax (maxSumSquared, sumSquared);
+        }
+
+        if (maxSumSquared >= 1e-8f)
+            buffer.applyGain (0.125f / std::sqrt (maxSumSquared));
+    }
+
+    // Writes a block into a ring at position, which then moves past it
+    template <typename SampleType>
+    void writeToRing (juce::AudioBuffer<SampleType>& ring, int& position, const juce::AudioBuffer<SampleType>& block,
+                      int numChannels, int numSamples) noexcept
+    {
+        const int length = ring.getNumSamples();
+
+        for (int done = 0; length > 0 && done < numSamples;)
+        {
+            const int numThisTime = juce::jmin (numSamples - done, length - position);
+
+            for (int ch = 0; ch < juce::jmin (numChannels, ring.getNumChannels()); ++ch)
+                ring.copyFrom (ch, position, block, ch, done, numThisTime);
+
+            position = (position + numThisTime) % length;
+            done += numThisTime;
+        }
+    }
+
+    // Reads from a ring into part of a block with a gain ramp, or adds to what the block holds
+    template <typename SampleType>
+    void readFromRing (const juce::AudioBuffer<SampleType>& ring, int position, juce::AudioBuffer<SampleType>& block,
+                       int startSample, int numChannels, int numSamples, float startGain, float endGain, bool add) noexcept
+    {
+        const int length = ring.getNumSamples();
+
+        for (int done = 0; length > 0 && done < numSamples;)
+        {
+            const int numThisTime = juce::jmin (numSamples - done, length - position);
+            const auto gainAt = [&] (int n) { return (SampleType) (startGain + (endGain - startGain) * (float) n / (float) numSamples); };
+
+            for (int ch = 0; ch < juce::jmin (numChannels, ring.getNumChannels()); ++ch)
+            {
+                if (add)
+                    block.addFromWithRamp (ch, startSample + done, ring.getReadPointer (ch, position), numThisTime, gainAt (done), gainAt (done + numThisTime));
+                else
+                    block.copyFromWithRamp (ch, startSample + done, ring.getReadPointer (ch, position), numThisTime, gainAt (done), gainAt (done + numThisTime));
+            }
+
+            position = (position + numThisTime) % length;
+            done += numThisTime;
+        }
+    }
+
+    // Lengthens a ring, keeping its contents in order; the next write then goes to position 0
+    template <typename SampleType>
+    void growRing (juce::AudioBuffer<SampleType>& ring, int position, int newLength)
+    {
+        const int length = ring.getNumSamples();
+
+        if (length >= newLength)
+            return;
+
+        juce::AudioBuffer<SampleType> grown (2, newLength);
+        grown.clear();
+
+        // Oldest first, ending at the last sample
+        for (int ch = 0; ch < juce::jmin (2, ring.getNumChannels()); ++ch)
+        {
+            grown.copyFrom (ch, newLength - length, ring, ch, position, length - position);
+            grown.copyFrom (ch, newLength - position, ring, ch, 0, position);
+        }
+
+        ring = std::move (grown);
+    }
+
+    PartitionLayout createLayout (int irLength, const IRCache::Key& key)
+    {
+        if (key.numUniformSegments > 0)
+            return PartitionLayout::createUniform (irLength, key.headBlockSize, key.numUniformSegments);
+
+        return PartitionLayout::createNonUniform (irLength, key.headBlockSize, key.maxBlockSize,
+                                                  key.latencySamples, key.directHeadLength, key.offloadBlockSize);
+    }
+
+    // Every source is cut where its own decay ends and the longest cut is kept, since all sources share one layout.
+    // The fade starts at the cut.
+    int findAutoTrimLength (juce::AudioBuffer<float>& buffer, int channelsPerSource, float floorDb, int fadeLength)
+    {
+        int end = 0;
+
+        for (int first = 0; first < buffer.getNumChannels(); first += channelsPerSource)
+        {
+            const juce::AudioBuffer<float> source (buffer.getArrayOfWritePointers() + first,
+                                                   juce::jmin (channelsPerSource, buffer.getNumChannels() - first),
+                                                   buffer.getNumSamples());
+            end = juce::jmax (end, IRProcessor::findTailEndSample (source, floorDb));
+        }
+
+        return juce::jmin (buffer.getNumSamples(), end + fadeLength);
+    }
+
+    // Far below any audible tail, or any auto-trim floor in use
+    constexpr float minimumPhaseTrimFloorDb = -120.0f;
+
+    // The transform's FFTs grow with the IR, so the silence or noise after the decay is cut off first
+    void convertToMinimumPhase (juce::AudioBuffer<float>& buffer, int channelsPerSource, float autoTrimFloorDb)
+    {
+        IRProcessor::trimBuffer (buffer, findAutoTrimLength (buffer, channelsPerSource, juce::jmin (minimumPhaseTrimFloorDb, autoTrimFloorDb), 0));
+        IRProcessor::convertToMinimumPhase (buffer);
+    }
+
+    // juce::dsp::Convolution takes at most two IR channels; of a true stereo IR it keeps LL and RR,
+    // of a blend or morph the first IR
+    juce::AudioBuffer<float> getJuceConvolutionIR (const juce::AudioBuffer<float>& irBuffer, bool isMultiSource)
+    {
+        juce::AudioBuffer<float> result;
+
+        if (irBuffer.getNumChannels() <= 2)
+        {
+            result.makeCopyOf (irBuffer);
+            return result;
+        }
+
+        result.setSize (2, irBuffer.getNumSamples());
+        result.copyFrom (0, 0, irBuffer, 0, 0, irBuffer.getNumSamples());
+        result.copyFrom (1, 0, irBuffer, isMultiSource ? 1 : 3, 0, irBuffer.getNumSamples());
+        return result;
+    }
+
+    const char* getRoutingName (ConvolutionEngine::ChannelRouting routing)
+    {
+        switch (routing)
+        {
+            case ConvolutionEngine::ChannelRouting::perChannel:   return "per channel";
+            case ConvolutionEngine::ChannelRouting::monoToStereo: return "mono to stereo";
+            case ConvolutionEngine::ChannelRouting::trueStereo:   return "true stereo";
+        }
+
+        return "";
+    }
+
+    // The FIR head runs per sample, so its length is capped to keep the cost bounded
+    constexpr int maxDirectHeadLength = 256;
+    constexpr int maxPartitionSize = 8192;
+
+    // Smaller segments are cheap enough that handing them to a thread costs more than it saves
+    constexpr int minWorkerBlockSize = 1024;
 
-        for (int ch = 0; ch < channels; ++ch)
+    // How long an offline prepareToPlay waits for the IR to be rebuilt for the offline layout
+    constexpr int offlineLoadTimeoutMs = 30000;
+
+    // Share of an IR load's progress taken by each stage
+    constexpr float decodeProgressEnd = 0.4f;
+    constexpr float resampleProgressEnd = 0.6f;
+
+    int chooseHeadBlockSize (int internalBlockSize, ConvolutionEngine::Algorithm algorithm)
+    {
+        if (algorithm == ConvolutionEngine::Algorithm::offline)
+            return ConvolutionEngine::offlineBlockSize;
+
+        const int maxHead = algorithm == ConvolutionEngine::Algorithm::zeroLatency ? maxDirectHeadLength : 4096;
+        return juce::jlimit (32, maxHead, juce::nextPowerOfTwo (juce::jmax (1, internalBlockSize)));
+    }
+
+    const char* getSchedulingName (PartitionedConvolver::Scheduling scheduling)
+    {
+        switch (scheduling)
+        {
+            case PartitionedConvolver::Scheduling::audioThread:     return "audio thread";
+            case PartitionedConvolver::Scheduling::workerThreads:   return "worker threads";
+            case PartitionedConvolver::Scheduling::timeDistributed: return "time distributed";
+            case PartitionedConvolver::Scheduling::offlineWorkers:  return "offline workers";
+        }
+
+        return "";
+    }
+
+    const char* getAlgorithmName (ConvolutionEngine::Algorithm algorithm)
+    {
+        switch (algorithm)
         {
-            juce::LagrangeInterpolator resampler;
-            resampler.reset();
-            resampler.process(ratio,
-                              input.getReadPointer(ch),
-                              output.getWritePointer(ch),
-                              outputSamples);
+            case ConvolutionEngine::Algorithm::juceUniform:           return "JUCE uniform";
+            case ConvolutionEngine::Algorithm::nonUniformPartitioned: return "non-uniform";
+            case ConvolutionEngine::Algorithm::zeroLatency:           return "zero latency";
+            case ConvolutionEngine::Algorithm::offline:               return "offline";
         }
 
-        return output;
+        return "";
     }
 }
 
+//==============================================================================
+class ConvolutionEngine::ConvolverReclaimer : private juce::Thread
+{
+public:
+    ConvolverReclaimer()
+        : juce::Thread ("Convolver reclaimer")
+    {
+        startThread (juce::Thread::Priority::low);
+    }
+
+    ~ConvolverReclaimer() override
+    {
+        stopThread (1000);
+        deleteRetired();
+    }
+
+    // Audio thread. Leaves the convolver with the caller if the queue is full.
+    bool retire (std::unique_ptr<PublishedConvolver>& convolver) noexcept
+    {
+        const auto scope = fifo.write (1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        retired[(size_t) scope.startIndex1] = convolver.release();
+        return true;
+    }
+
+    bool canRetire() const noexcept { return fifo.getFreeSpace() > 0; }
+
+private:
+    void run() override
+    {
+        // Polls rather than being signalled, so the audio thread never touches a lock
+        while (! threadShouldExit())
+        {
+            deleteRetired();
+            wait (50);
+        }
+    }
+
+    void deleteRetired()
+    {
+        const auto scope = fifo.read (fifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            delete std::exchange (retired[(size_t) (scope.startIndex1 + i)], nullptr);
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            delete std::exchange (retired[(size_t) (scope.startIndex2 + i)], nullptr);
+    }
+
+    static constexpr int capacity = 16;
+    juce::AbstractFifo fifo { capacity };
+    std::array<PublishedConvolver*, capacity> retired {};
+};
+
+//==============================================================================
 ConvolutionEngine::ConvolutionEngine()
+    : kernels (SimdKernels::selectKernels()),
+      reclaimer (std::make_unique<ConvolverReclaimer>())
 {
     DBG("=== ConvolutionEngine CONSTRUCTOR ===");
+    DBG("  SIMD kernels: " + juce::String (kernels.name));
+
+    for (auto& gain : blendGains)
+        gain.store (1.0f);
+
+    // The shared pool has no threads on a single core machine
+    if (workerPool->getNumThreads() == 0)
+        tailScheduling = PartitionedConvolver::Scheduling::timeDistributed;
 }
 
 ConvolutionEngine::~ConvolutionEngine()
 {
     DBG("=== ConvolutionEngine DESTRUCTOR ===");
+
+    {
+        const juce::ScopedLock sl (loadLock);
+
+        if (currentLoad != nullptr)
+            currentLoad->cancel();
+
+        if (currentRateVariants != nullptr)
+            currentRateVariants->cancel();
+    }
+
+    loadPool.removeAllJobs (true, 10000);
+    delete pendingConvolver.exchange (nullptr);
 }
 
-void ConvolutionEngine::prepareToPlay (double sampleRate, int samplesPerBlock)
+void ConvolutionEngine::prepareToPlay (double sampleRate, int samplesPerBlock, Algorithm algorithmToUse, int numInputChannelsToUse)
 {
     juce::Logger::writeToLog("=== ConvolutionEngine::prepareToPlay START ===");
-    juce::Logger::writeToLog("  sampleRate: " + juce::String(sampleRate) + ", blockSize: " + juce::String(samplesPerBlock));
-    
-    currentSampleRate = sampleRate;
-    currentBlockSize = samplesPerBlock;
-    
-    // Prepare on first call or when device settings change
+    juce::Logger::writeToLog("  sampleRate: " + juce::String(sampleRate) + ", blockSize: " + juce::String(samplesPerBlock)
+                             + ", algorithm: " + getAlgorithmName (algorithmToUse)
+                             + ", inputs: " + juce::String (numInputChannelsToUse));
+
+    numInputChannelsToUse = juce::jlimit (1, 2, numInputChannelsToUse);
+
+    // Prepare on first call or when device settings change. Everything runs in internal
+    // blocks of headBlockSize, so the host's block size alone never needs a rebuild.
+    const int headBlockSizeToUse = chooseHeadBlockSize (internalBlockSize.load(), algorithmToUse);
     const bool needsPrepare = !isPrepared.load()
         || lastPreparedSampleRate != sampleRate
-        || lastPreparedBlockSize != samplesPerBlock;
+        || headBlockSize != headBlockSizeToUse
+        || algorithm != algorithmToUse
+        || numInputChannels != numInputChannelsToUse;
+
+    {
+        // Loads in flight pick up the new settings and rebuild
+        const juce::ScopedLock sl (loadLock);
+        currentSampleRate = sampleRate;
+        currentBlockSize = samplesPerBlock;
+
+        if (lastPreparedSampleRate > 0.0 && lastPreparedSampleRate != sampleRate)
+            previousSampleRate = lastPreparedSampleRate;
+
+        if (needsPrepare)
+        {
+            algorithm = algorithmToUse;
+            headBlockSize = headBlockSizeToUse;
+            numInputChannels = numInputChannelsToUse;
+            ++settingsGeneration;
+        }
+    }
 
     if (needsPrepare)
     {
-        juce::dsp::ProcessSpec spec;
-        spec.sampleRate = sampleRate;
-        spec.maximumBlockSize = samplesPerBlock;
-        spec.numChannels = 2;
-        convolver.prepare(spec);
+        // The JUCE convolvers keep their IRs across prepare and are always fed headBlockSize chunks.
+        // The audio thread is stopped, so the playing one, and one not picked up yet, can be redone here.
+        {
+            const juce::ScopedLock sl (loadLock);
+
+            for (auto* published : { playingConvolver.get(), fadingOutConvolver.get(), pendingConvolver.load() })
+                if (published != nullptr && published->uniform != nullptr)
+                    prepareUniformConvolver (*published->uniform, currentSampleRate, headBlockSize);
+        }
+
+        std::get<0> (crossfadeBuffers).setSize (2, headBlockSize);
+        std::get<1> (crossfadeBuffers).setSize (2, headBlockSize);
+        juceConversionBuffer.setSize (2, headBlockSize);
+
+        // Whatever plays keeps its latency until the convolver for the new settings replaces it, so the
+        // ring holds either latency plus a chunk, and keeps its contents unless the rate has changed
+        if (playingConvolver == nullptr)
+            playingLatency.store (getLatencyFor (algorithm, headBlockSize));
+
+        const int ringLength = juce::jmax (playingLatency.load(), fadingOutLatency, getLatencyFor (algorithm, headBlockSize)) + headBlockSize;
+
+        if (std::get<0> (dryDelayLines).getNumSamples() < ringLength)
+        {
+            growRing (std::get<0> (dryDelayLines), dryDelayPosition, ringLength);
+            growRing (std::get<1> (dryDelayLines), dryDelayPosition, ringLength);
+            dryDelayPosition = 0;
+        }
+
+        if (lastPreparedSampleRate != sampleRate)
+        {
+            std::get<0> (dryDelayLines).clear();
+            std::get<1> (dryDelayLines).clear();
+        }
+
+        std::get<0> (dryBuffers).setSize (2, headBlockSize);
+        std::get<1> (dryBuffers).setSize (2, headBlockSize);
+        mixRamp.reset (sampleRate, mixRampSeconds);
+        mixRamp.setCurrentAndTargetValue (mix.load());
         isPrepared.store(true);
+        resetBlockCost();
         lastPreparedSampleRate = sampleRate;
-        lastPreparedBlockSize = samplesPerBlock;
-        juce::Logger::writeToLog("  Convolver prepared (" + juce::String(sampleRate) + " Hz, block " + juce::String(samplesPerBlock) + ")");
+        juce::Logger::writeToLog("  Convolver prepared (" + juce::String(sampleRate) + " Hz, block " + juce::String(samplesPerBlock)
+                                 + ", head partition " + juce::String(headBlockSize) + ")");
         
         // If an IR was deferred (UI loaded IR before prepareToPlay), load it now
+        // Both loads run in the background; the previous engine keeps playing until they finish
         if (deferredIRFile.existsAsFile())
         {
             juce::Logger::writeToLog("  Loading deferred IR: " + deferredIRFile.getFileName());
-            loadImpulseResponse(deferredIRFile);
+            loadImpulseResponseAsync(deferredIRFile);
             deferredIRFile = juce::File(); // Clear the deferred file
         }
-        else if (irLoaded.load() && lastLoadedIRPath.isNotEmpty())
+        else if (irLoaded.load() && ! isLoadInProgress() && swapInCachedPartitions())
+        {
+            juce::Logger::writeToLog ("  Swapped in cached partitions for the new settings - no reload needed");
+        }
+        else if (irLoaded.load() && ! isLoadInProgress())
         {
-            juce::Logger::writeToLog("  Reloading IR after prepareToPlay change: " + lastLoadedIRPath);
-            loadImpulseResponse(juce::File(lastLoadedIRPath));
+            juce::Array<juce::File> irFiles;
+            auto sources = IRLoadHandle::Sources::single;
+            LoadedSource source;
+
+            {
+                const juce::ScopedLock sl (loadLock);
+                irFiles = lastLoadedFiles;
+                sources = lastLoadedSources;
+                source = lastLoadedSource;
+                lastLoadedIRPath.clear(); // Force a rebuild for the new rate / partition size
+            }
+
+            // Rebuilt from the decoded copy on the loading thread; the playing convolver runs until it is ready
+            if (! irFiles.isEmpty())
+            {
+                juce::Logger::writeToLog("  Rebuilding IR after prepareToPlay change: " + irFiles.getReference (0).getFullPathName());
+                startLoad (std::make_shared<IRLoadHandle> (irFiles, sources), {}, source);
+            }
         }
     }
     else
     {
-        juce::Logger::writeToLog("  Convolver already prepared - skipping re-prepare");
+        juce::Logger::writeToLog("  Convolver already prepared - skipping re-prepare (block size is handled in "
+                                 + juce::String (headBlockSize) + "-sample internal blocks)");
     }
     
+    if (algorithm == Algorithm::offline)
+        finishLoadingForOfflineRender();
+
     juce::Logger::writeToLog("=== ConvolutionEngine::prepareToPlay END ===" );
 }
 
 void ConvolutionEngine::processBlock (juce::AudioBuffer<float>& buffer)
+{
+    processSamples (buffer);
+}
+
+void ConvolutionEngine::processBlock (juce::AudioBuffer<double>& buffer)
+{
+    processSamples (buffer);
+}
+
+template <typename SampleType>
+void ConvolutionEngine::processSamples (juce::AudioBuffer<SampleType>& buffer)
 {
     static int processCallCount = 0;
     processCallCount++;
@@ -100,217 +453,1227 @@ void ConvolutionEngine::processBlock (juce::AudioBuffer<float>& buffer)
     // RULE 1: If bypassed OR no IR loaded -> pass audio through unchanged
     // RULE 2: If IR loaded AND not bypassed -> apply convolution
     
+    // RULE 0: Before prepareToPlay has sized the internal blocks there is nothing to run them in -
+    // the audio passes through untouched rather than spin on zero-length chunks
+    auto& dryBuffer = std::get<juce::AudioBuffer<SampleType>> (dryBuffers);
+
+    if (! isPrepared.load() || dryBuffer.getNumSamples() == 0)
+        return;
+
     bool shouldBypass = bypass.load() || !irLoaded.load();
     
     if (shouldBypass)
     {
-        // Bypass mode or no IR - audio passes through unchanged
+        // Bypass mode or no IR - audio passes through, delayed by the latency the host compensates for
         static int bypassLogCount = 0;
         if (bypassLogCount++ < 5)
         {
             float level = 0.0f;
             for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-                level = juce::jmax(level, buffer.getRMSLevel(ch, 0, buffer.getNumSamples()));
+                level = juce::jmax(level, (float) buffer.getRMSLevel(ch, 0, buffer.getNumSamples()));
             
-            juce::String reason = bypass ? "BYPASS=ON" : "NO_IR";
-            juce::Logger::writeToLog("PASSTHROUGH #" + juce::String(bypassLogCount) + " (" + reason + 
-                                     ") - channels=" + juce::String(buffer.getNumChannels()) + 
-                                     " level=" + juce::String(level, 4));
+            audioLog.post (bypass ? "PASSTHROUGH #{} (BYPASS=ON) - channels={} level={}" : "PASSTHROUGH #{} (NO_IR) - channels={} level={}",
+                           { (double) bypassLogCount, (double) buffer.getNumChannels(), (double) level });
         }
-        // Buffer already contains input audio - just return
-        return;
     }
     
     // IR is loaded AND bypass is OFF - apply convolution
     static int convolveLogCount = 0;
-    bool shouldLog = (convolveLogCount < 10);
+    bool shouldLog = ! shouldBypass && (convolveLogCount < 10);
     
     if (shouldLog)
     {
         float inLevel = 0.0f;
         for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            inLevel = juce::jmax(inLevel, buffer.getRMSLevel(ch, 0, buffer.getNumSamples()));
-        juce::Logger::writeToLog(">>> CONVOLVE #" + juce::String(convolveLogCount + 1) + " - INPUT level=" + 
-                                 juce::String(inLevel, 4) + " channels=" + juce::String(buffer.getNumChannels()) + 
-                                 " samples=" + juce::String(buffer.getNumSamples()));
+            inLevel = juce::jmax(inLevel, (float) buffer.getRMSLevel(ch, 0, buffer.getNumSamples()));
+        audioLog.post (">>> CONVOLVE #{} - INPUT level={} channels={} samples={}",
+                       { (double) (convolveLogCount + 1), (double) inLevel, (double) buffer.getNumChannels(), (double) buffer.getNumSamples() });
     }
     
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
-    
     try
     {
-        convolver.process (context);
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const int numDryChannels = juce::jmin (buffer.getNumChannels(), dryBuffer.getNumChannels());
+        mixRamp.setTargetValue (mix.load (std::memory_order_relaxed));
+
+        // The dry signal always runs through the delay, so bypass, mix changes and IR loads stay in line
+        for (int start = 0; start < buffer.getNumSamples(); start += dryBuffer.getNumSamples())
+        {
+            const int numThisTime = juce::jmin (buffer.getNumSamples() - start, dryBuffer.getNumSamples());
+            juce::AudioBuffer<SampleType> chunk (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numThisTime);
+
+            for (int ch = 0; ch < numDryChannels; ++ch)
+                dryBuffer.copyFrom (ch, 0, chunk, ch, 0, numThisTime);
+
+            // A new convolver brings its latency with it, so dry and wet switch in the same crossfade
+            if (! shouldBypass)
+                pickUpPendingConvolver();
+
+            delayDry (dryBuffer, numDryChannels, numThisTime);
+
+            if (shouldBypass)
+            {
+                for (int ch = 0; ch < numDryChannels; ++ch)
+                    chunk.copyFrom (ch, 0, dryBuffer, ch, 0, numThisTime);
+
+                // A crossfade caught by bypass still runs out, so the dry delay settles on the new latency
+                if (crossfadeRemaining > 0)
+                    crossfadeRemaining = juce::jmax (0, crossfadeRemaining - numThisTime);
+
+                if (fadingOutConvolver != nullptr && crossfadeRemaining == 0)
+                    reclaimer->retire (fadingOutConvolver);
+
+                if (outputMeter != nullptr)
+                    outputMeter->add (LevelMeter::Stage::output, chunk);
+
+                continue;
+            }
+
+            convolveBlock (chunk);
+
+            if (mixRamp.isSmoothing() || mixRamp.getTargetValue() < 1.0f)
+            {
+                const float startWet = mixRamp.getCurrentValue();
+                const float endWet = mixRamp.skip (numThisTime);
+
+                for (int ch = 0; ch < numDryChannels; ++ch)
+                {
+                    chunk.applyGainRamp (ch, 0, numThisTime, (SampleType) startWet, (SampleType) endWet);
+                    chunk.addFromWithRamp (ch, 0, dryBuffer.getReadPointer (ch), numThisTime,
+                                           (SampleType) (1.0f - startWet), (SampleType) (1.0f - endWet));
+                }
+            }
+
+            // Metered while the chunk just written is still in cache, not in a second pass over the block
+            if (outputMeter != nullptr)
+                outputMeter->add (LevelMeter::Stage::output, chunk);
+        }
+
+        if (shouldBypass)
+            return;
+
+        recordBlockCost (juce::Time::getHighResolutionTicks() - startTicks);
         convolveLogCount++;
         
         if (shouldLog)
         {
             float outLevel = 0.0f;
             for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-                outLevel = juce::jmax(outLevel, buffer.getRMSLevel(ch, 0, buffer.getNumSamples()));
-            juce::Logger::writeToLog(">>> CONVOLVE #" + juce::String(convolveLogCount) + " - OUTPUT level=" + juce::String(outLevel, 4));
+                outLevel = juce::jmax(outLevel, (float) buffer.getRMSLevel(ch, 0, buffer.getNumSamples()));
+            audioLog.post (">>> CONVOLVE #{} - OUTPUT level={}", { (double) convolveLogCount, (double) outLevel });
         }
     }
     catch (const std::exception& e)
     {
-        juce::Logger::writeToLog("ERROR in convolver.process(): " + juce::String(e.what()));
+        audioLog.post ("ERROR in convolver.process()", {}, e.what());
         // On error, clear the buffer to prevent glitches
         buffer.clear();
     }
 }
 
-bool ConvolutionEngine::loadImpulseResponse (const juce::File& irFile)
+void ConvolutionEngine::pickUpPendingConvolver() noexcept
 {
-    juce::Logger::writeToLog("=== ConvolutionEngine::loadImpulseResponse START ===");
-    juce::Logger::writeToLog("  File: " + irFile.getFullPathName());
+    // Only once the previous crossfade has finished
+    if (fadingOutConvolver != nullptr || ! reclaimer->canRetire())
+        return;
 
-    if (irLoaded.load() && lastLoadedIRPath == irFile.getFullPathName())
+    if (auto* incoming = pendingConvolver.exchange (nullptr))
     {
-        juce::Logger::writeToLog("  IR already loaded - skipping reload");
-        return true;
+        fadingOutConvolver = std::move (playingConvolver);
+        playingConvolver.reset (incoming);
+        fadingOutLatency = playingLatency.load (std::memory_order_relaxed);
+        playingLatency.store (incoming->getLatencySamples(), std::memory_order_relaxed);
+
+        crossfadeLength = juce::roundToInt (crossfadeSeconds.load() * currentSampleRate);
+        crossfadeRemaining = fadingOutConvolver != nullptr ? crossfadeLength : 0;
+
+        if (fadingOutConvolver != nullptr && crossfadeRemaining == 0)
+            reclaimer->retire (fadingOutConvolver);
     }
-    
-    if (!irFile.existsAsFile())
+}
+
+template <typename SampleType>
+void ConvolutionEngine::delayDry (juce::AudioBuffer<SampleType>& dryBuffer, int numChannels, int numSamples) noexcept
+{
+    auto& ring = std::get<juce::AudioBuffer<SampleType>> (dryDelayLines);
+    const int length = ring.getNumSamples();
+
+    if (length == 0)
+        return;
+
+    writeToRing (ring, dryDelayPosition, dryBuffer, numChannels, numSamples);
+
+    // Where the sample written `offset` into this chunk is, delayed by `latency`
+    const auto readPosition = [&] (int latency, int offset)
     {
-        juce::Logger::writeToLog("  ERROR: IR file not found!");
-        irLoaded = false;
-        return false;
-    }
-    
-    juce::Logger::writeToLog("  File exists - reading audio file...");
-    
-    try
+        return ((dryDelayPosition - numSamples - latency + offset) % length + length) % length;
+    };
+
+    const int latency = playingLatency.load (std::memory_order_relaxed);
+    int numFading = 0;
+
+    if (fadingOutConvolver != nullptr && crossfadeRemaining > 0 && fadingOutLatency != latency)
     {
-        juce::AudioFormatManager formatManager;
-        formatManager.registerBasicFormats();
+        // Same ramp as the wet crossfade over the part of the chunk it covers
+        numFading = juce::jmin (numSamples, crossfadeRemaining);
+        const float startGain = 1.0f - (float) crossfadeRemaining / (float) crossfadeLength;
+        const float endGain = 1.0f - (float) (crossfadeRemaining - numFading) / (float) crossfadeLength;
 
-        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(irFile));
-        if (reader == nullptr)
-        {
-            juce::Logger::writeToLog("  ERROR: Cannot read audio file!");
-            irLoaded = false;
-            return false;
-        }
+        readFromRing (ring, readPosition (latency, 0), dryBuffer, 0, numChannels, numFading, startGain, endGain, false);
+        readFromRing (ring, readPosition (fadingOutLatency, 0), dryBuffer, 0, numChannels, numFading, 1.0f - startGain, 1.0f - endGain, true);
+    }
 
-        juce::Logger::writeToLog("  File info: " + juce::String((int)reader->lengthInSamples) +
-                                 " samples, " + juce::String(reader->numChannels) +
-                                 " channels, " + juce::String((int)reader->sampleRate) + " Hz");
+    readFromRing (ring, readPosition (latency, numFading), dryBuffer, numFading, numChannels, numSamples - numFading, 1.0f, 1.0f, false);
+}
 
-        juce::AudioBuffer<float> irBuffer((int)reader->numChannels, (int)reader->lengthInSamples);
-        reader->read(irBuffer.getArrayOfWritePointers(), irBuffer.getNumChannels(), 0, irBuffer.getNumSamples());
+template <typename SampleType>
+void ConvolutionEngine::convolveBlock (juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    if (playingConvolver == nullptr)
+        return;
 
-        double irSampleRate = reader->sampleRate;
-        int irChannels = (int)reader->numChannels;
-        
-        // Check for sample rate mismatch and warn user
-        if (currentSampleRate > 0.0 && std::abs(irSampleRate - currentSampleRate) > 0.1)
-        {
-            juce::Logger::writeToLog("  WARNING: IR sample rate (" + juce::String((int)irSampleRate) + 
-                                     " Hz) != device sample rate (" + juce::String((int)currentSampleRate) +
-                                     " Hz)");
-            juce::Logger::writeToLog("  For best results, record IRs at your device's native sample rate.");
+    auto& crossfadeBuffer = std::get<juce::AudioBuffer<SampleType>> (crossfadeBuffers);
 
-            if (resampleIrToDevice.load())
-            {
-                juce::Logger::writeToLog("  Matching IR to device rate by resampling...");
+    // Blend gains ramp inside the convolvers; an unchanged target leaves a running ramp alone.
+    // Morphs move their partitions a few at a time, so the position can be passed straight on.
+    for (auto* published : { playingConvolver.get(), fadingOutConvolver.get() })
+    {
+        if (published == nullptr || published->partitioned == nullptr)
+            continue;
 
-                irBuffer = resampleIrBuffer(irBuffer, irSampleRate, currentSampleRate);
-                irSampleRate = currentSampleRate;
+        auto& conv = *published->partitioned;
 
-                juce::Logger::writeToLog("  Resampled IR: " + juce::String(irBuffer.getNumSamples()) +
-                                         " samples at " + juce::String((int)irSampleRate) + " Hz");
-            }
-            else
-            {
-                juce::Logger::writeToLog("  Resample disabled - loading IR at original rate.");
-            }
-        }
+        for (int source = 0; source < conv.getNumGainGroups(); ++source)
+            conv.setGain (source, blendGains[(size_t) source].load (std::memory_order_relaxed));
 
-        juce::Logger::writeToLog("  File loaded into buffer, now loading into convolver...");
+        conv.setMorphPosition (morphPosition.load (std::memory_order_relaxed));
+    }
 
-        // Self-test: run a local convolver on a constant signal to verify sustained output
-        // Important: Use the DEVICE sample rate for test, not the IR file sample rate
-        if (currentSampleRate > 0.0 && currentBlockSize > 0)
-        {
-            juce::AudioBuffer<float> irBufferForTest;
-            irBufferForTest.makeCopyOf (irBuffer);
+    // Once the input has been silent for longer than the tail every output sample is silence too,
+    // so the partitioned convolver is not run at all. Its state then holds nothing audible and it
+    // picks up again where it stopped when signal returns.
+    bool canSleep = false;
 
-            juce::dsp::Convolution testConvolver;
-            juce::dsp::ProcessSpec testSpec;
-            testSpec.sampleRate = currentSampleRate;  // Use device SR, not file SR
-            testSpec.maximumBlockSize = static_cast<juce::uint32> (currentBlockSize);
-            testSpec.numChannels = static_cast<juce::uint32> (irBuffer.getNumChannels());
-            testConvolver.prepare (testSpec);
+    if (auto* partitioned = playingConvolver->partitioned.get())
+    {
+        bool inputIsSilent = true;
 
-            testConvolver.loadImpulseResponse (std::move (irBufferForTest),
-                                               irSampleRate,  // Source IR sample rate  
-                                               irChannels == 2 ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
-                                               juce::dsp::Convolution::Trim::no,
-                                               juce::dsp::Convolution::Normalise::yes);
+        for (int ch = 0; ch < buffer.getNumChannels() && inputIsSilent; ++ch)
+            inputIsSilent = buffer.getMagnitude (ch, 0, buffer.getNumSamples()) < (SampleType) PartitionedConvolver::silenceThreshold;
 
-            juce::AudioBuffer<float> testBlock (irBuffer.getNumChannels(), currentBlockSize);
+        silentInputSamples = inputIsSilent ? silentInputSamples + buffer.getNumSamples() : 0;
+        canSleep = inputIsSilent && crossfadeRemaining == 0
+                   && silentInputSamples > partitioned->getTailLength() + buffer.getNumSamples();
+    }
 
-            for (int i = 0; i < 10; ++i)
-            {
-                testBlock.clear();
-                if (i == 0)
-                {
-                    for (int ch = 0; ch < testBlock.getNumChannels(); ++ch)
-                        testBlock.setSample (ch, 0, 1.0f);
-                }
+    if (sleeping.load (std::memory_order_relaxed) != canSleep)
+        sleeping.store (canSleep, std::memory_order_relaxed);
 
-                juce::dsp::AudioBlock<float> testAudioBlock (testBlock);
-                juce::dsp::ProcessContextReplacing<float> testContext (testAudioBlock);
-                testConvolver.process (testContext);
+    if (canSleep)
+    {
+        buffer.clear();
+        return;
+    }
 
-                float testRms = 0.0f;
-                for (int ch = 0; ch < testBlock.getNumChannels(); ++ch)
-                    testRms = juce::jmax (testRms, testBlock.getRMSLevel (ch, 0, testBlock.getNumSamples()));
+    const int numChannels = juce::jmin (buffer.getNumChannels(), crossfadeBuffer.getNumChannels());
+    int done = 0;
 
-                juce::Logger::writeToLog ("  SelfTest block #" + juce::String (i + 1) + " RMS=" + juce::String (testRms, 6));
-            }
-        }
-        else
+    // Run both convolvers on the same input and ramp from the old output to the new one
+    while (crossfadeRemaining > 0 && done < buffer.getNumSamples())
+    {
+        const int numThisTime = juce::jmin (buffer.getNumSamples() - done, crossfadeBuffer.getNumSamples(), crossfadeRemaining);
+        const float startGain = 1.0f - (float) crossfadeRemaining / (float) crossfadeLength;
+        const float endGain = 1.0f - (float) (crossfadeRemaining - numThisTime) / (float) crossfadeLength;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            crossfadeBuffer.copyFrom (ch, 0, buffer, ch, done, numThisTime);
+
+        juce::AudioBuffer<SampleType> oldBlock (crossfadeBuffer.getArrayOfWritePointers(), numChannels, 0, numThisTime);
+        juce::AudioBuffer<SampleType> newBlock (buffer.getArrayOfWritePointers(), numChannels, done, numThisTime);
+        runConvolver (*fadingOutConvolver, oldBlock, numChannels);
+        runConvolver (*playingConvolver, newBlock, numChannels);
+
+        for (int ch = 0; ch < numChannels; ++ch)
         {
-            juce::Logger::writeToLog ("  SelfTest skipped (invalid sample rate/block size)");
+            newBlock.applyGainRamp (ch, 0, numThisTime, (SampleType) startGain, (SampleType) endGain);
+            newBlock.addFromWithRamp (ch, 0, oldBlock.getReadPointer (ch), numThisTime, (SampleType) (1.0f - startGain), (SampleType) (1.0f - endGain));
         }
 
-        // Load IR into main convolver
-        convolver.loadImpulseResponse(std::move(irBuffer),
-                          irSampleRate,  // Source IR sample rate
-                          irChannels == 2 ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
-                          juce::dsp::Convolution::Trim::no,
-                          juce::dsp::Convolution::Normalise::yes);
-
-        juce::Logger::writeToLog("  SUCCESS: IR loaded into convolver (" + irFile.getFileName() + ")");
-        
-        // Do NOT reset here - let the next processBlock do the reset if needed
-        
-        lastLoadedIRPath = irFile.getFullPathName();
-        irLoaded.store(true);
-        
-        juce::Logger::writeToLog("  irLoaded flag set to: true");
-        juce::Logger::writeToLog("=== ConvolutionEngine::loadImpulseResponse END (SUCCESS) ===");
-        return true;
+        crossfadeRemaining -= numThisTime;
+        done += numThisTime;
     }
-    catch (const std::exception& e)
+
+    if (done < buffer.getNumSamples())
     {
-        juce::Logger::writeToLog("  EXCEPTION during loadImpulseResponse: " + juce::String(e.what()));
-        irLoaded = false;
-        return false;
+        juce::AudioBuffer<SampleType> rest (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), done, buffer.getNumSamples() - done);
+        runConvolver (*playingConvolver, rest, rest.getNumChannels());
     }
+
+    // Never delete on the audio thread - hand the old convolver to the reclaimer
+    if (fadingOutConvolver != nullptr && crossfadeRemaining == 0)
+        reclaimer->retire (fadingOutConvolver);
 }
 
-bool ConvolutionEngine::loadImpulseResponseFromMemory (const void* data, size_t size)
+template <typename SampleType>
+void ConvolutionEngine::runConvolver (PublishedConvolver& published, juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
 {
-    DBG("=== loadImpulseResponseFromMemory START ===");
-    convolver.loadImpulseResponse (data,
-                                   size,
-                                   juce::dsp::Convolution::Stereo::yes,
-                                   juce::dsp::Convolution::Trim::yes,
-                                   0,
-                                   juce::dsp::Convolution::Normalise::yes);
-    
+    // A partitioned convolver built for a mono input reads only the first channel and writes both
+    if (auto* partitioned = published.partitioned.get())
+        partitioned->process (buffer.getArrayOfReadPointers(), juce::jmin (numChannels, partitioned->getNumInputs()),
+                              buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+    else if (published.uniform != nullptr)
+        processUniform (*published.uniform, buffer);
+}
+
+template <typename SampleType>
+void ConvolutionEngine::processUniform (juce::dsp::Convolution& uniform, juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        // Chunks no longer than the block the JUCE convolver was prepared for
+        juce::dsp::AudioBlock<float> block (buffer);
+
+        for (size_t start = 0; start < block.getNumSamples(); start += (size_t) juceConversionBuffer.getNumSamples())
+        {
+            auto chunk = block.getSubBlock (start, juce::jmin ((size_t) juceConversionBuffer.getNumSamples(), block.getNumSamples() - start));
+            juce::dsp::ProcessContextReplacing<float> context (chunk);
+            uniform.process (context);
+        }
+    }
+    else
+    {
+        // juce::dsp::Convolution is float only, so double blocks go through a float copy
+        const int numChannels = juce::jmin (buffer.getNumChannels(), juceConversionBuffer.getNumChannels());
+
+        for (int start = 0; start < buffer.getNumSamples(); start += juceConversionBuffer.getNumSamples())
+        {
+            const int numThisTime = juce::jmin (buffer.getNumSamples() - start, juceConversionBuffer.getNumSamples());
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy_n (buffer.getReadPointer (ch, start), numThisTime, juceConversionBuffer.getWritePointer (ch));
+
+            juce::dsp::AudioBlock<float> block (juceConversionBuffer.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numThisTime);
+            juce::dsp::ProcessContextReplacing<float> context (block);
+            uniform.process (context);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy_n (juceConversionBuffer.getReadPointer (ch), numThisTime, buffer.getWritePointer (ch, start));
+        }
+    }
+}
+
+bool ConvolutionEngine::loadImpulseResponse (const juce::File& irFile)
+{
+    {
+        const juce::ScopedLock sl (loadLock);
+
+        if (irLoaded.load() && lastLoadedIRPath == irFile.getFullPathName() && lastLoadedSources == IRLoadHandle::Sources::single)
+        {
+            juce::Logger::writeToLog("  IR already loaded - skipping reload: " + irFile.getFileName());
+            return true;
+        }
+    }
+
+    IRLoadHandle handle (irFile);
+    return runLoad (handle, {});
+}
+
+std::shared_ptr<IRLoadHandle> ConvolutionEngine::loadImpulseResponseAsync (const juce::File& irFile, LoadCallback onComplete)
+{
+    return startLoad (std::make_shared<IRLoadHandle> (irFile), std::move (onComplete), {});
+}
+
+std::shared_ptr<IRLoadHandle> ConvolutionEngine::loadTrueStereoImpulseResponseAsync (const juce::File& leftInputFile,
+                                                                                    const juce::File& rightInputFile,
+                                                                                    LoadCallback onComplete)
+{
+    return startLoad (std::make_shared<IRLoadHandle> (juce::Array<juce::File> { leftInputFile, rightInputFile },
+                                                      IRLoadHandle::Sources::trueStereoPair),
+                      std::move (onComplete), {});
+}
+
+std::shared_ptr<IRLoadHandle> ConvolutionEngine::loadBlendAsync (const juce::Array<juce::File>& irFiles, LoadCallback onComplete)
+{
+    jassert (juce::isPositiveAndNotGreaterThan (irFiles.size(), maxBlendSources));
+
+    juce::Array<juce::File> files (irFiles);
+    files.resize (juce::jlimit (1, maxBlendSources, files.size()));
+    return startLoad (std::make_shared<IRLoadHandle> (files, IRLoadHandle::Sources::blend), std::move (onComplete), {});
+}
+
+void ConvolutionEngine::setBlendGain (int source, float gain) noexcept
+{
+    if (juce::isPositiveAndBelow (source, maxBlendSources))
+        blendGains[(size_t) source].store (juce::jmax (0.0f, gain));
+}
+
+std::shared_ptr<IRLoadHandle> ConvolutionEngine::loadMorphAsync (const juce::Array<juce::File>& irFiles, LoadCallback onComplete)
+{
+    jassert (! irFiles.isEmpty());
+    return startLoad (std::make_shared<IRLoadHandle> (irFiles, IRLoadHandle::Sources::morph), std::move (onComplete), {});
+}
+
+float ConvolutionEngine::getBlendGain (int source) const noexcept
+{
+    return juce::isPositiveAndBelow (source, maxBlendSources) ? blendGains[(size_t) source].load() : 0.0f;
+}
+
+std::shared_ptr<IRLoadHandle> ConvolutionEngine::startLoad (std::shared_ptr<IRLoadHandle> handle, LoadCallback onComplete,
+                                                          LoadedSource rebuildFrom)
+{
+    {
+        // The newest request wins - anything still loading is no longer wanted
+        const juce::ScopedLock sl (loadLock);
+
+        if (currentLoad != nullptr)
+            currentLoad->cancel();
+
+        if (currentRateVariants != nullptr)
+            currentRateVariants->cancel();
+
+        currentLoad = handle;
+    }
+
+    loadPool.addJob ([this, handle, onComplete, rebuildFrom]
+    {
+        runLoad (*handle, rebuildFrom);
+
+        if (onComplete == nullptr)
+            return;
+
+        if (juce::MessageManager::getInstanceWithoutCreating() != nullptr)
+            juce::MessageManager::callAsync ([handle, onComplete] { onComplete (*handle); });
+        else
+            onComplete (*handle);
+    });
+
+    return handle;
+}
+
+void ConvolutionEngine::finishLoadingForOfflineRender()
+{
+    std::shared_ptr<IRLoadHandle> load;
+
+    {
+        const juce::ScopedLock sl (loadLock);
+        load = currentLoad;
+    }
+
+    // Nothing plays until the render starts, so it can wait for the rebuild instead of crossfading into it
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) offlineLoadTimeoutMs;
+
+    while (load != nullptr && ! load->isDone() && juce::Time::getMillisecondCounter() < deadline)
+        juce::Thread::sleep (1);
+
+    if (load != nullptr && ! load->isDone())
+        juce::Logger::writeToLog ("  Offline render starting before the IR rebuild finished");
+
+    if (auto* incoming = pendingConvolver.exchange (nullptr))
+    {
+        fadingOutConvolver.reset();
+        playingConvolver.reset (incoming);
+        playingLatency.store (incoming->getLatencySamples());
+        crossfadeRemaining = 0;
+    }
+
+    // Every bounce starts from silence
+    if (playingConvolver != nullptr && playingConvolver->partitioned != nullptr)
+        playingConvolver->partitioned->reset();
+    else if (playingConvolver != nullptr)
+        playingConvolver->uniform->reset();
+
+    std::get<0> (dryDelayLines).clear();
+    std::get<1> (dryDelayLines).clear();
+    silentInputSamples = 0;
+}
+
+bool ConvolutionEngine::isLoadInProgress() const
+{
+    const juce::ScopedLock sl (loadLock);
+    return currentLoad != nullptr && ! currentLoad->isDone();
+}
+
+ConvolutionEngine::LoadSettings ConvolutionEngine::getLoadSettings() const
+{
+    const juce::ScopedLock sl (loadLock);
+    return { currentSampleRate, currentBlockSize, algorithm, headBlockSize, resampleIrToDevice.load(), resamplerQuality.load(),
+             autoTrimEnabled.load(), autoTrimFloor.load(), irTransform.load(), numInputChannels,
+             offlineMultithreaded.load() ? 1 + getNumWorkerThreads() : 1,
+             tailScheduling.load() == PartitionedConvolver::Scheduling::workerThreads && getNumWorkerThreads() > 0 ? minWorkerBlockSize : 0,
+             settingsGeneration };
+}
+
+bool ConvolutionEngine::runLoad (IRLoadHandle& handle, const LoadedSource& rebuildFrom)
+{
+    const auto& irFile = handle.getFile();
+    const auto& irFiles = handle.getFiles();
+    const auto sources = handle.getSources();
+    const bool isMultiSource = sources == IRLoadHandle::Sources::blend || sources == IRLoadHandle::Sources::morph;
+    const bool isMultiFile = sources != IRLoadHandle::Sources::single;
+    const int numSources = isMultiSource ? irFiles.size() : 1;
+    juce::Logger::writeToLog("=== ConvolutionEngine::loadImpulseResponse START ===");
+
+    for (const auto& file : irFiles)
+        juce::Logger::writeToLog("  File: " + file.getFullPathName());
+
+    auto fail = [this, &handle] (const juce::String& message)
+    {
+        juce::Logger::writeToLog ("  ERROR: " + message);
+        handle.errorMessage = message;
+        handle.state.store (IRLoadHandle::State::failed);
+        irLoaded = false;
+        return false;
+    };
+
+    auto cancelled = [&handle]
+    {
+        if (! handle.isCancelRequested())
+            return false;
+
+        juce::Logger::writeToLog ("  Load cancelled: " + handle.getFile().getFileName());
+        handle.state.store (IRLoadHandle::State::cancelled);
+        return true;
+    };
+
+    // Rebuilds for new settings already know the source, so they only read the files if no partitions are cached
+    LoadedSource source = rebuildFrom;
+
+    if (source.contentHash.isNotEmpty())
+    {
+        juce::Logger::writeToLog (source.decoded != nullptr ? "  Rebuilding from the decoded IR in memory" : "  Rebuilding from the known IR files");
+    }
+    else
+    {
+        for (const auto& file : irFiles)
+            if (!file.existsAsFile())
+                return fail ("IR file not found!");
+
+        juce::Logger::writeToLog("  File exists - reading audio file...");
+    }
+
+    handle.state.store (IRLoadHandle::State::decoding);
+    
+    try
+    {
+        if (source.contentHash.isEmpty())
+        {
+            juce::AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            // With several files each one gives two channels: in a true stereo pair one input's response
+            // at the left and right outputs, in a blend one stereo IR
+            int irChannels = 0;
+            int irLength = 0;
+            double fileSampleRate = 0.0;
+
+            for (const auto& file : irFiles)
+            {
+                std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+                if (reader == nullptr)
+                    return fail ("Cannot read audio file!");
+
+                juce::Logger::writeToLog("  File info: " + juce::String((int)reader->lengthInSamples) +
+                                         " samples, " + juce::String(reader->numChannels) +
+                                         " channels, " + juce::String((int)reader->sampleRate) + " Hz");
+
+                if (fileSampleRate > 0.0 && std::abs (reader->sampleRate - fileSampleRate) > 0.1)
+                    return fail ("IR files have different sample rates!");
+
+                irChannels += isMultiFile ? 2 : (int) reader->numChannels;
+                irLength = juce::jmax (irLength, (int) reader->lengthInSamples);
+                fileSampleRate = reader->sampleRate;
+            }
+
+            // Identical files share cached partitions no matter where they live on disk
+            // Blends and morphs are normalised per IR, so they never share partitions with a pair of the same files
+            juce::StringArray fileHashes;
+            for (const auto& file : irFiles)
+                fileHashes.add (juce::MD5 (file).toHexString());
+
+            // Decoding only depends on the files and whether mono files are spread to two channels
+            const auto decodedKey = (isMultiFile ? "files_" : "") + fileHashes.joinIntoString ("_");
+
+            // The samples are only decoded once no cached partitions fit, unless another instance holds them already
+            source = { (isMultiSource ? "blend_" : "") + fileHashes.joinIntoString ("_"), fileSampleRate,
+                       irChannels / numSources, numSources, sources, irCache->findDecoded (decodedKey), decodedKey, irLength };
+
+            if (source.decoded != nullptr)
+                juce::Logger::writeToLog ("  Sharing the decoded IR of another instance");
+        }
+
+        handle.progress.store (decodeProgressEnd);
+        const int irChannels = source.channelsPerSource * source.numSources;
+        const int irLength = source.length;
+        const double fileSampleRate = source.sampleRate;
+
+        // Retried if prepareToPlay changes the rate, block size or algorithm while this load is running
+        for (;;)
+        {
+            const auto settings = getLoadSettings();
+            const bool partitioned = settings.algorithm != Algorithm::juceUniform;
+            const bool needsResample = settings.resample && settings.sampleRate > 0.0
+                                       && std::abs (fileSampleRate - settings.sampleRate) > 0.1;
+            const auto cacheKey = makeCacheKey (source, settings);
+
+            std::unique_ptr<PartitionedConvolver> newConvolver;
+            std::unique_ptr<juce::dsp::Convolution> newUniformConvolver;
+            juce::AudioBuffer<float> irBuffer;
+            double irSampleRate = fileSampleRate;
+            const int untrimmedLength = needsResample ? (int) std::ceil (irLength * settings.sampleRate / fileSampleRate) : irLength;
+            int trimmedLength = untrimmedLength;
+            int untransformedLength = -1;     // Known only when the IR is processed here
+            double transformMs = 0.0;
+
+            if (auto cached = partitioned ? irCache->find (cacheKey) : IRCache::ChannelIRs(); ! cached.empty())
+            {
+                juce::Logger::writeToLog ("  Using cached partitions (" + cacheKey.toString() + ")");
+                trimmedLength = cached.front()->getLayout().irLength;
+                newConvolver = createPartitionedConvolver (cached, settings, sources, numSources);
+            }
+            else
+            {
+                if (! decodeSource (irFiles, source, handle))
+                {
+                    if (cancelled())
+                        return false;
+
+                    return fail (handle.errorMessage);
+                }
+
+                irBuffer.makeCopyOf (*source.decoded);
+                handle.state.store (IRLoadHandle::State::resampling);
+
+                // Check for sample rate mismatch and warn user
+                if (settings.sampleRate > 0.0 && std::abs(irSampleRate - settings.sampleRate) > 0.1)
+                {
+                    juce::Logger::writeToLog("  WARNING: IR sample rate (" + juce::String((int)irSampleRate) + 
+                                             " Hz) != device sample rate (" + juce::String((int)settings.sampleRate) +
+                                             " Hz)");
+                    juce::Logger::writeToLog("  For best results, record IRs at your device's native sample rate.");
+
+                    if (needsResample)
+                    {
+                        juce::Logger::writeToLog("  Matching IR to device rate by resampling...");
+
+                        const auto startMs = juce::Time::getMillisecondCounterHiRes();
+                        irBuffer = PolyphaseResampler::resample (irBuffer, irSampleRate, settings.sampleRate, settings.resamplerQuality);
+                        irSampleRate = settings.sampleRate;
+
+                        juce::Logger::writeToLog("  Resampled IR: " + juce::String(irBuffer.getNumSamples()) +
+                                                 " samples at " + juce::String((int)irSampleRate) + " Hz ("
+                                                 + PolyphaseResampler::getQualityName (settings.resamplerQuality) + ", "
+                                                 + juce::String (juce::Time::getMillisecondCounterHiRes() - startMs, 1) + " ms)");
+                    }
+                    else
+                    {
+                        juce::Logger::writeToLog("  Resample disabled - loading IR at original rate.");
+                    }
+                }
+
+                const int fadeLength = juce::roundToInt (autoTrimFadeSeconds * irSampleRate);
+
+                if (settings.transform == IRTransform::minimumPhase)
+                {
+                    // Where the IR would have been cut without the transform, to report what it saves
+                    if (settings.autoTrim)
+                        untransformedLength = findAutoTrimLength (irBuffer, irChannels / numSources, settings.autoTrimFloor, fadeLength);
+
+                    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+                    convertToMinimumPhase (irBuffer, irChannels / numSources, settings.autoTrimFloor);
+                    transformMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+                    juce::Logger::writeToLog ("  Converted to minimum phase in " + juce::String (transformMs, 1) + " ms");
+                }
+
+                if (cancelled())
+                    return false;
+
+                if (settings.autoTrim)
+                {
+                    IRProcessor::trimBuffer (irBuffer, findAutoTrimLength (irBuffer, irChannels / numSources, settings.autoTrimFloor, fadeLength),
+                                             fadeLength);
+                    juce::Logger::writeToLog ("  Auto-trim at " + juce::String (settings.autoTrimFloor, 0) + " dB: "
+                                              + juce::String (untrimmedLength) + " -> " + juce::String (irBuffer.getNumSamples()) + " samples");
+                }
+
+                trimmedLength = irBuffer.getNumSamples();
+
+                if (untransformedLength < 0)
+                    untransformedLength = trimmedLength;
+                handle.progress.store (resampleProgressEnd);
+
+                if (cancelled())
+                    return false;
+
+                juce::Logger::writeToLog("  File loaded into buffer, now loading into convolver...");
+                handle.state.store (IRLoadHandle::State::preparing);
+
+                // Build the new engine completely before anything is published
+                if (partitioned)
+                {
+                    auto channels = partitionImpulseResponse (irBuffer, settings, irChannels / numSources, handle);
+
+                    if (channels.empty())
+                    {
+                        cancelled();
+                        return false;
+                    }
+
+                    newConvolver = createPartitionedConvolver (irCache->insert (cacheKey, std::move (channels)), settings, sources, numSources);
+                }
+                else
+                {
+                    newUniformConvolver = createUniformConvolver (getJuceConvolutionIR (irBuffer, isMultiSource), irSampleRate, settings);
+                }
+            }
+
+            const juce::ScopedLock sl (loadLock);
+
+            if (settings.generation != settingsGeneration)
+            {
+                juce::Logger::writeToLog ("  Settings changed during load - rebuilding");
+                continue;
+            }
+
+            if (cancelled())
+                return false;
+
+            // Publish the new convolver; the audio thread crossfades to it
+            auto published = std::make_unique<PublishedConvolver>();
+
+            if (newConvolver != nullptr)
+            {
+                channelRouting.store (chooseRouting (irChannels / numSources, newConvolver->getNumInputs()));
+                tailSeconds.store (newConvolver->getTailLength() / settings.sampleRate);
+                numBlendSources.store (newConvolver->getNumGainGroups());
+                morphLoaded.store (newConvolver->getNumMorphs() > 0);
+                published->partitioned = std::move (newConvolver);
+            }
+            else
+            {
+                if (isMultiSource)
+                    juce::Logger::writeToLog ("  Blends and morphs need a partitioned algorithm - using the first IR only");
+                else if (irChannels > 2)
+                    juce::Logger::writeToLog ("  True stereo needs a partitioned algorithm - using the LL and RR paths only");
+
+                tailSeconds.store (irBuffer.getNumSamples() / irSampleRate);
+                channelRouting.store (ChannelRouting::perChannel);
+                numBlendSources.store (1);
+                morphLoaded.store (false);
+                published->uniform = std::move (newUniformConvolver);
+            }
+
+            // Anything still pending was never seen by the audio thread, so it can be freed right here
+            delete pendingConvolver.exchange (published.release());
+
+            trimReport = {};
+            trimReport.secondsSaved = (untrimmedLength - trimmedLength) / cacheKey.sampleRate;
+            trimReport.partitionsSaved = getNumPartitionsFor (untrimmedLength, settings) - getNumPartitionsFor (trimmedLength, settings);
+
+            if (untransformedLength >= 0)
+            {
+                trimReport.transformSecondsSaved = (untransformedLength - trimmedLength) / cacheKey.sampleRate;
+                trimReport.transformPartitionsSaved = getNumPartitionsFor (untransformedLength, settings) - getNumPartitionsFor (trimmedLength, settings);
+                trimReport.transformMs = transformMs;
+
+                if (settings.transform != IRTransform::none)
+                    juce::Logger::writeToLog ("  Minimum phase: " + juce::String (trimReport.transformSecondsSaved, 2) + " s and "
+                                              + juce::String (trimReport.transformPartitionsSaved) + " partitions saved");
+            }
+
+            juce::Logger::writeToLog("  SUCCESS: IR loaded into convolver (" + irFile.getFileName() + ")");
+            
+            // Do NOT reset here - let the next processBlock do the reset if needed
+            
+            lastLoadedIRPath = irFile.getFullPathName();
+            lastLoadedFiles = irFiles;
+            lastLoadedSources = sources;
+            lastLoadedSource = source;
+            irLoaded.store(true);
+            handle.progress.store (1.0f);
+            handle.state.store (IRLoadHandle::State::finished);
+            
+            juce::Logger::writeToLog("  irLoaded flag set to: true");
+
+            // Only sessions that have changed rate are likely to again. Offline renders run at one rate
+            // and are gone before it could change.
+            if (partitioned && settings.resample && settings.algorithm != Algorithm::offline && rateVariantsEnabled.load()
+                && previousSampleRate > 0.0)
+                startRateVariants (source, settings, previousSampleRate);
+
+            juce::Logger::writeToLog("=== ConvolutionEngine::loadImpulseResponse END (SUCCESS) ===");
+            return true;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        return fail ("EXCEPTION during loadImpulseResponse: " + juce::String(e.what()));
+    }
+}
+
+void ConvolutionEngine::startRateVariants (const LoadedSource& source, const LoadSettings& settings, double previousRate)
+{
+    auto handle = std::make_shared<IRLoadHandle> (lastLoadedFiles, source.sources);
+
+    {
+        const juce::ScopedLock sl (loadLock);
+
+        if (currentRateVariants != nullptr)
+            currentRateVariants->cancel();
+
+        currentRateVariants = handle;
+    }
+
+    // Queued behind nothing but later loads, which cancel it
+    loadPool.addJob ([this, handle, source, settings, previousRate]
+    {
+        buildRateVariants (*handle, source, settings, previousRate);
+    });
+}
+
+bool ConvolutionEngine::decodeSource (const juce::Array<juce::File>& files, LoadedSource& source, IRLoadHandle& handle)
+{
+    if (source.decoded != nullptr)
+        return true;
+
+    if (auto shared = irCache->findDecoded (source.decodedKey))
+    {
+        source.decoded = std::move (shared);
+        return true;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    const bool isMultiFile = source.sources != IRLoadHandle::Sources::single;
+    juce::AudioBuffer<float> decodedBuffer (source.channelsPerSource * source.numSources, source.length);
+    decodedBuffer.clear();
+
+    // Decode in chunks so progress and cancellation stay responsive on long IRs
+    constexpr int decodeChunkSize = 65536;
+    const auto totalSamples = (float) source.length * (float) files.size();
+    int firstChannel = 0;
+    int samplesDone = 0;
+
+    for (const auto& file : files)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+        if (reader == nullptr)
+        {
+            handle.errorMessage = "Cannot read audio file!";
+            return false;
+        }
+
+        const int numFileChannels = isMultiFile ? 2 : (int) reader->numChannels;
+        const int numToRead = juce::jmin ((int) reader->numChannels, numFileChannels);
+        const int length = juce::jmin ((int) reader->lengthInSamples, source.length);
+
+        if (firstChannel + numFileChannels > decodedBuffer.getNumChannels())
+        {
+            handle.errorMessage = "IR file changed since it was loaded!";
+            return false;
+        }
+
+        for (int start = 0; start < length; start += decodeChunkSize)
+        {
+            if (handle.isCancelRequested())
+                return false;
+
+            const int numThisTime = juce::jmin (decodeChunkSize, length - start);
+            juce::AudioBuffer<float> chunk (decodedBuffer.getArrayOfWritePointers() + firstChannel, numToRead, start, numThisTime);
+            reader->read (chunk.getArrayOfWritePointers(), numToRead, start, numThisTime);
+            samplesDone += numThisTime;
+            handle.progress.store (decodeProgressEnd * (float) samplesDone / totalSamples);
+        }
+
+        // A mono file among several sends its input to both outputs
+        if (numToRead < numFileChannels)
+            decodedBuffer.copyFrom (firstChannel + 1, 0, decodedBuffer, firstChannel, 0, source.length);
+
+        firstChannel += numFileChannels;
+    }
+
+    source.decoded = irCache->insertDecoded (source.decodedKey, std::make_shared<const juce::AudioBuffer<float>> (std::move (decodedBuffer)));
+    return true;
+}
+
+void ConvolutionEngine::buildRateVariants (IRLoadHandle& handle, LoadedSource source, LoadSettings settings, double previousRate)
+{
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    juce::StringArray built, found;
+
+    // The playing rate first, so switching back to it is instant as well, then the one before the
+    // last change and the nearest standard rates below and above this one
+    std::vector<double> rates { settings.sampleRate };
+    const auto addRate = [&rates] (double rate)
+    {
+        if (rate > 0.0 && std::none_of (rates.begin(), rates.end(), [rate] (double r) { return std::abs (r - rate) <= 0.1; }))
+            rates.push_back (rate);
+    };
+
+    addRate (previousRate);
+
+    const auto above = std::find_if (variantSampleRates.begin(), variantSampleRates.end(),
+                                     [&settings] (double rate) { return rate > settings.sampleRate + 0.1; });
+
+    if (above != variantSampleRates.end())
+        addRate (*above);
+
+    const auto below = std::find_if (variantSampleRates.rbegin(), variantSampleRates.rend(),
+                                     [&settings] (double rate) { return rate < settings.sampleRate - 0.1; });
+
+    if (below != variantSampleRates.rend())
+        addRate (*below);
+
+    for (const auto rate : rates)
+    {
+        if (handle.isCancelRequested())
+        {
+            juce::Logger::writeToLog ("  Rate variants cancelled by a newer load");
+            return;
+        }
+
+        settings.sampleRate = rate;
+        const auto key = makeCacheKey (source, settings);
+        const auto rateName = juce::String (juce::roundToInt (rate));
+
+        if (auto cached = irCache->find (key); ! cached.empty())
+        {
+            irCache->retain (key, cached);
+            found.add (rateName);
+            continue;
+        }
+
+        // The same steps as a load, without the trim report
+        if (! decodeSource (handle.getFiles(), source, handle))
+        {
+            juce::Logger::writeToLog ("  Rate variants stopped: " + (handle.isCancelRequested() ? juce::String ("cancelled by a newer load")
+                                                                                                  : handle.errorMessage));
+            return;
+        }
+
+        juce::AudioBuffer<float> irBuffer;
+        irBuffer.makeCopyOf (*source.decoded);
+
+        if (std::abs (source.sampleRate - rate) > 0.1)
+            irBuffer = PolyphaseResampler::resample (irBuffer, source.sampleRate, rate, settings.resamplerQuality);
+
+        if (settings.transform == IRTransform::minimumPhase)
+            convertToMinimumPhase (irBuffer, source.channelsPerSource, settings.autoTrimFloor);
+
+        if (settings.autoTrim)
+        {
+            const int fadeLength = juce::roundToInt (autoTrimFadeSeconds * rate);
+            IRProcessor::trimBuffer (irBuffer, findAutoTrimLength (irBuffer, source.channelsPerSource, settings.autoTrimFloor, fadeLength),
+                                     fadeLength);
+        }
+
+        auto channels = partitionImpulseResponse (irBuffer, settings, source.channelsPerSource, handle);
+
+        if (! channels.empty())
+        {
+            irCache->retain (key, irCache->insert (key, std::move (channels)));
+            built.add (rateName);
+        }
+    }
+
+    juce::Logger::writeToLog ("  Rate variants ready in " + juce::String (juce::roundToInt (juce::Time::getMillisecondCounterHiRes() - startMs)) + " ms"
+                              + (built.isEmpty() ? juce::String() : ", built " + built.joinIntoString (" "))
+                              + (found.isEmpty() ? juce::String() : ", cached " + found.joinIntoString (" ")));
+}
+
+bool ConvolutionEngine::swapInCachedPartitions()
+{
+    const auto settings = getLoadSettings();
+    LoadedSource source;
+
+    {
+        const juce::ScopedLock sl (loadLock);
+        source = lastLoadedSource;
+    }
+
+    if (settings.algorithm == Algorithm::juceUniform || source.contentHash.isEmpty())
+        return false;
+
+    const auto cached = irCache->find (makeCacheKey (source, settings));
+
+    if (cached.empty())
+        return false;
+
+    auto newConvolver = createPartitionedConvolver (cached, settings, source.sources, source.numSources);
+    channelRouting.store (chooseRouting (source.channelsPerSource, newConvolver->getNumInputs()));
+    tailSeconds.store (newConvolver->getTailLength() / settings.sampleRate);
+    numBlendSources.store (newConvolver->getNumGainGroups());
+    morphLoaded.store (newConvolver->getNumMorphs() > 0);
+
+    // The audio thread is stopped during prepareToPlay, and the old convolver belongs to the old rate, so no crossfade
+    delete pendingConvolver.exchange (nullptr);
+    fadingOutConvolver.reset();
+    playingConvolver = std::make_unique<PublishedConvolver>();
+    playingConvolver->partitioned = std::move (newConvolver);
+    playingLatency.store (playingConvolver->getLatencySamples());
+    crossfadeRemaining = 0;
+    return true;
+}
+
+std::unique_ptr<juce::dsp::Convolution> ConvolutionEngine::createUniformConvolver (juce::AudioBuffer<float>&& irBuffer, double irSampleRate,
+                                                                                    const LoadSettings& settings)
+{
+    const int numChannels = irBuffer.getNumChannels();
+    auto uniform = std::make_unique<juce::dsp::Convolution>();
+    uniform->loadImpulseResponse (std::move (irBuffer),
+                                  irSampleRate,  // Source IR sample rate
+                                  numChannels == 2 ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
+                                  juce::dsp::Convolution::Trim::no,
+                                  juce::dsp::Convolution::Normalise::yes);
+
+    // Preparing runs the queued load on this thread, so the IR is in place before anything is published
+    prepareUniformConvolver (*uniform, settings.sampleRate, settings.headBlockSize);
+    return uniform;
+}
+
+void ConvolutionEngine::prepareUniformConvolver (juce::dsp::Convolution& uniform, double sampleRate, int blockSize)
+{
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = (juce::uint32) blockSize;
+    spec.numChannels = 2;
+    uniform.prepare (spec);
+}
+
+ConvolutionEngine::ChannelRouting ConvolutionEngine::chooseRouting (int numIRChannels, int numInputChannelsToUse) noexcept
+{
+    if (numIRChannels >= 4)
+        return ChannelRouting::trueStereo;
+
+    return numInputChannelsToUse == 1 ? ChannelRouting::monoToStereo : ChannelRouting::perChannel;
+}
+
+IRCache::Key ConvolutionEngine::makeCacheKey (const juce::String& contentHash, double irSampleRate, const LoadSettings& settings)
+{
+    IRCache::Key key;
+    key.contentHash = contentHash + (settings.transform == IRTransform::minimumPhase ? "_minphase" : "")
+                    + (settings.autoTrim ? "_trim" + juce::String (juce::roundToInt (-settings.autoTrimFloor)) : juce::String());
+    key.sampleRate = irSampleRate;
+    key.headBlockSize = settings.headBlockSize;
+    key.maxBlockSize = maxPartitionSize;
+    key.latencySamples = getLatencyFor (settings.algorithm, settings.headBlockSize);
+    key.directHeadLength = settings.algorithm == Algorithm::zeroLatency ? settings.headBlockSize : 0;
+    key.numUniformSegments = settings.algorithm == Algorithm::offline ? settings.numOfflineSegments : 0;
+    key.offloadBlockSize = settings.algorithm == Algorithm::offline ? 0 : settings.workerBlockSize;
+    return key;
+}
+
+IRCache::Key ConvolutionEngine::makeCacheKey (const LoadedSource& source, const LoadSettings& settings)
+{
+    // Resampled partitions depend on the resampler preset; those at the files' own rate do not
+    if (settings.resample && settings.sampleRate > 0.0 && std::abs (source.sampleRate - settings.sampleRate) > 0.1)
+        return makeCacheKey (source.contentHash + "_" + PolyphaseResampler::getQualityName (settings.resamplerQuality),
+                             settings.sampleRate, settings);
+
+    return makeCacheKey (source.contentHash, source.sampleRate, settings);
+}
+
+ConvolutionEngine::TrimReport ConvolutionEngine::getTrimReport() const
+{
+    const juce::ScopedLock sl (loadLock);
+    return trimReport;
+}
+
+int ConvolutionEngine::getNumPartitionsFor (int irLength, const LoadSettings& settings)
+{
+    const auto key = makeCacheKey ({}, 0.0, settings);
+    return createLayout (irLength, key).getNumPartitions();
+}
+
+IRCache::ChannelIRs ConvolutionEngine::partitionImpulseResponse (const juce::AudioBuffer<float>& irBuffer,
+                                                                 const LoadSettings& settings,
+                                                                 int channelsPerSource,
+                                                                 IRLoadHandle& handle)
+{
+    juce::AudioBuffer<float> normalised;
+    normalised.makeCopyOf (irBuffer);
+
+    // Channels of one source keep their balance; blended sources are levelled against each other
+    for (int first = 0; first < normalised.getNumChannels(); first += channelsPerSource)
+    {
+        juce::AudioBuffer<float> source (normalised.getArrayOfWritePointers() + first,
+                                         juce::jmin (channelsPerSource, normalised.getNumChannels() - first),
+                                         normalised.getNumSamples());
+        normaliseIrBuffer (source);
+    }
+
+    // Zero latency: the first headBlockSize taps run as a FIR, so the partitions may start one block late
+    const auto key = makeCacheKey ({}, 0.0, settings);
+    const auto layout = createLayout (normalised.getNumSamples(), key);
+
+    IRCache::ChannelIRs channels;
+
+    for (int ch = 0; ch < normalised.getNumChannels(); ++ch)
+    {
+        if (handle.isCancelRequested())
+            return {};
+
+        channels.push_back (std::make_shared<const PartitionedIR> (layout, normalised.getReadPointer (ch), normalised.getNumSamples()));
+        handle.progress.store (juce::jmap ((float) (ch + 1) / (float) normalised.getNumChannels(), resampleProgressEnd, 1.0f));
+    }
+
+    return channels;
+}
+
+std::unique_ptr<PartitionedConvolver> ConvolutionEngine::createPartitionedConvolver (const IRCache::ChannelIRs& channelIRs,
+                                                                                   const LoadSettings& settings,
+                                                                                   IRLoadHandle::Sources sources,
+                                                                                   int numSources)
+{
+    jassert (! channelIRs.empty());
+    const auto& layout = channelIRs.front()->getLayout();
+    auto newConvolver = std::make_unique<PartitionedConvolver> (kernels);
+
+    // Worker threads need a pool; without one the late segments are spread over the audio callbacks instead
+    auto scheduling = tailScheduling.load();
+    if (scheduling == PartitionedConvolver::Scheduling::workerThreads && workerPool->getNumThreads() == 0)
+        scheduling = PartitionedConvolver::Scheduling::timeDistributed;
+
+    // Offline there are no callbacks to spread work over: runs go to the workers, which the render
+    // waits for rather than drop a late result, or stay on the calling thread
+    if (settings.algorithm == Algorithm::offline)
+        scheduling = layout.segments.size() > 1 && workerPool->getNumThreads() > 0
+                         ? PartitionedConvolver::Scheduling::offlineWorkers
+                         : PartitionedConvolver::Scheduling::audioThread;
+
+    newConvolver->setScheduling (scheduling, &workerPool.get(),
+                                 scheduling == PartitionedConvolver::Scheduling::workerThreads ? minWorkerBlockSize : 0);
+    const int numInputs = juce::jlimit (1, 2, settings.numInputChannels);
+    const int channelsPerSource = (int) channelIRs.size() / numSources;
+    const auto routing = chooseRouting (channelsPerSource, numInputs);
+    newConvolver->prepare (layout, numInputs, 2, getLatencyFor (settings.algorithm, settings.headBlockSize));
+
+    // A morph has one set of paths reading interpolated IRs, one per IR channel
+    const bool isMorph = sources == IRLoadHandle::Sources::morph;
+    std::vector<std::shared_ptr<SpectralMorph>> morphs;
+
+    if (isMorph)
+    {
+        for (int index = 0; index < channelsPerSource; ++index)
+        {
+            std::vector<std::shared_ptr<const PartitionedIR>> morphSources;
+
+            for (int source = 0; source < numSources; ++source)
+                morphSources.push_back (channelIRs[(size_t) (source * channelsPerSource + index)]);
+
+            morphs.push_back (std::make_shared<SpectralMorph> (std::move (morphSources), getMorphPosition()));
+        }
+    }
+
+    // Every blended source gets the same paths in its own gain group, so all of them share the input transforms
+    for (int source = 0; source < (isMorph ? 1 : numSources); ++source)
+    {
+        auto addPath = [&] (int input, int output, int index)
+        {
+            index = juce::jmin (index, channelsPerSource - 1);
+
+            if (isMorph)
+                newConvolver->addPath (input, output, morphs[(size_t) index]);
+            else
+                newConvolver->addPath (input, output, channelIRs[(size_t) (source * channelsPerSource + index)], source);
+        };
+
+        switch (routing)
+        {
+            case ChannelRouting::trueStereo:
+                // A mono input drives both input paths
+                for (int in = 0; in < 2; ++in)
+                    for (int out = 0; out < 2; ++out)
+                        addPath (juce::jmin (in, numInputs - 1), out, in * 2 + out);
+                break;
+
+            case ChannelRouting::monoToStereo:
+                addPath (0, 0, 0);
+                addPath (0, 1, 1);
+                break;
+
+            case ChannelRouting::perChannel:
+                // Stereo IRs map L->L and R->R, mono IRs feed both channels (as juce::dsp::Convolution does)
+                for (int ch = 0; ch < 2; ++ch)
+                    addPath (ch, ch, ch);
+                break;
+        }
+    }
+
+    newConvolver->setGainRampLength (juce::roundToInt (blendRampSeconds * settings.sampleRate));
+
+    for (int source = 0; source < newConvolver->getNumGainGroups(); ++source)
+        newConvolver->setGain (source, getBlendGain (source), false);
+
+    juce::Logger::writeToLog ("  Partitioned IR: " + juce::String ((int) layout.segments.size()) + " segments, "
+                              + juce::String (layout.getNumPartitions()) + " partitions (head "
+                              + juce::String (layout.headBlockSize) + ", max " + juce::String (layout.getMaxBlockSize())
+                              + ", FIR head " + juce::String (layout.directHeadLength) + " taps, "
+                              + juce::String (newConvolver->getNumOffloadedSegments()) + " segments rescheduled, "
+                              + getSchedulingName (scheduling) + ", " + getRoutingName (routing)
+                              + (numSources > 1 ? (isMorph ? ", morph of " : ", blend of ") + juce::String (numSources) : juce::String()) + ")");
+
+    return newConvolver;
+}
+
+void ConvolutionEngine::recordBlockCost (juce::int64 ticks) noexcept
+{
+    if (blockCostResetRequested.exchange (false))
+    {
+        blockCostTotalTicks = 0;
+        blockCostWorstTicks = 0;
+        numTimedBlocks = 0;
+    }
+
+    blockCostTotalTicks = blockCostTotalTicks.load() + ticks;
+    blockCostWorstTicks = juce::jmax (blockCostWorstTicks.load(), ticks);
+    numTimedBlocks = numTimedBlocks.load() + 1;
+}
+
+ConvolutionEngine::BlockCost ConvolutionEngine::getBlockCost() const noexcept
+{
+    BlockCost cost;
+    cost.numBlocks = numTimedBlocks.load();
+
+    if (cost.numBlocks > 0)
+    {
+        cost.averageMs = juce::Time::highResolutionTicksToSeconds (blockCostTotalTicks.load()) * 1000.0 / (double) cost.numBlocks;
+        cost.worstMs = juce::Time::highResolutionTicksToSeconds (blockCostWorstTicks.load()) * 1000.0;
+    }
+
+    return cost;
+}
+
+ConvolutionWorkerPool::Stats ConvolutionEngine::getWorkerStats() const noexcept
+{
+    return workerPool->getStats();
+}
+
+int ConvolutionEngine::getLatencyFor (Algorithm algorithmToUse, int headBlockSizeToUse) noexcept
+{
+    return algorithmToUse == Algorithm::nonUniformPartitioned || algorithmToUse == Algorithm::offline ? headBlockSizeToUse : 0;
+}
+
+bool ConvolutionEngine::loadImpulseResponseFromMemory (const void* data, size_t size)
+{
+    DBG("=== loadImpulseResponseFromMemory START ===");
+    auto published = std::make_unique<PublishedConvolver>();
+    published->uniform = std::make_unique<juce::dsp::Convolution>();
+    published->uniform->loadImpulseResponse (data,
+                                             size,
+                                             juce::dsp::Convolution::Stereo::yes,
+                                             juce::dsp::Convolution::Trim::yes,
+                                             0,
+                                             juce::dsp::Convolution::Normalise::yes);
+
+    {
+        // Plays under any algorithm: there is no decoded copy to rebuild it from
+        const juce::ScopedLock sl (loadLock);
+        prepareUniformConvolver (*published->uniform, currentSampleRate, headBlockSize);
+        delete pendingConvolver.exchange (published.release());
+    }
+
     irLoaded = true;
     DBG("=== loadImpulseResponseFromMemory END (SUCCESS) ===");
     return true;
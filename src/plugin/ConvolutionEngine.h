@@ -1,6 +1,74 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+#include "ConvolutionWorkerPool.h"
+#include "IRCache.h"
+#include "PolyphaseResampler.h"
+#include "AudioLogger.h"
+#include "LevelMeter.h"
+
+/**
+ * Progress of one background IR load, shared by the caller and the loading thread.
+ */
+class IRLoadHandle
+{
+public:
+    enum class State
+    {
+        queued,
+        decoding,
+        resampling,
+        preparing,
+        finished,
+        failed,
+        cancelled
+    };
+
+    // How the files of one load combine
+    enum class Sources
+    {
+        single,             // One file with one, two or four (true stereo) channels
+        trueStereoPair,     // Responses to the left and the right input, two outputs each
+        blend,              // Several IRs mixed by ConvolutionEngine::setBlendGain
+        morph               // Several IRs interpolated by ConvolutionEngine::setMorphPosition
+    };
+
+    explicit IRLoadHandle (const juce::File& fileToLoad)
+        : IRLoadHandle (juce::Array<juce::File> { fileToLoad }, Sources::single) {}
+
+    IRLoadHandle (const juce::Array<juce::File>& filesToLoad, Sources sourcesToUse)
+        : files (filesToLoad), sources (sourcesToUse) { jassert (! files.isEmpty()); }
+
+    const juce::File& getFile() const noexcept { return files.getReference (0); }
+    const juce::Array<juce::File>& getFiles() const noexcept { return files; }
+    Sources getSources() const noexcept { return sources; }
+    State getState() const noexcept { return state.load(); }
+    float getProgress() const noexcept { return progress.load(); }   // 0 to 1
+    juce::String getErrorMessage() const { return errorMessage; }    // Valid once the state is failed
+
+    bool isDone() const noexcept
+    {
+        const auto s = getState();
+        return s == State::finished || s == State::failed || s == State::cancelled;
+    }
+
+    // The load stops at its next checkpoint and nothing is published
+    void cancel() noexcept { cancelRequested.store (true); }
+    bool isCancelRequested() const noexcept { return cancelRequested.load(); }
+
+private:
+    friend class ConvolutionEngine;
+
+    const juce::Array<juce::File> files;
+    const Sources sources;
+    std::atomic<State> state { State::queued };
+    std::atomic<float> progress { 0.0f };
+    std::atomic<bool> cancelRequested { false };
+    juce::String errorMessage;
+
+    JUCE_DECLARE_NON_COPYABLE (IRLoadHandle)
+};
 
 /**
  * Manages impulse response files and convolution operations
@@ -8,13 +76,74 @@
 class ConvolutionEngine
 {
 public:
+    enum class Algorithm
+    {
+        juceUniform,            // juce::dsp::Convolution, zero latency
+        nonUniformPartitioned,  // Can Damonium core, latency of one head block
+        zeroLatency,            // Direct-form FIR head + partitioned tail, no latency
+        offline                 // Uniform offlineBlockSize partitions for bounces: most throughput, latency of one such block
+    };
+
+    // Offline rendering waits for the IR to be rebuilt in prepareToPlay, then starts on it from the first sample
+    static constexpr int offlineBlockSize = 8192;
+
+    // Offline layouts are split into one run per worker thread plus one, which all convolve in parallel.
+    // Applies from the next prepareToPlay with the offline algorithm.
+    void setOfflineMultithreaded (bool shouldUseThreads) noexcept { offlineMultithreaded.store (shouldUseThreads); }
+    bool isOfflineMultithreaded() const noexcept { return offlineMultithreaded.load(); }
+
+    // Applied to every IR as it loads, before trimming
+    enum class IRTransform
+    {
+        none,
+        minimumPhase    // Same magnitude response with the energy pulled to the start, so it trims much shorter
+    };
+
+    // How IR channels connect inputs to outputs (partitioned algorithms only)
+    enum class ChannelRouting
+    {
+        perChannel,     // IR channel n filters input n; a mono IR filters both
+        monoToStereo,   // One input feeds the left and right outputs through the IR's two channels
+        trueStereo      // Four IR channels: LL, LR, RL, RR (input then output)
+    };
+
     ConvolutionEngine();
     ~ConvolutionEngine();
 
-    void prepareToPlay (double sampleRate, int samplesPerBlock);
+    void prepareToPlay (double sampleRate, int samplesPerBlock,
+                        Algorithm algorithmToUse = Algorithm::nonUniformPartitioned,
+                        int numInputChannels = 2);
+    // Double blocks run the same convolvers; samples are converted as they enter and leave the rings
     void processBlock (juce::AudioBuffer<float>& buffer);
+    void processBlock (juce::AudioBuffer<double>& buffer);
 
+    /** Each internal block of output is passed to this meter's output stage as soon as it is
+        written, so the caller only calls begin() and finish() around processBlock. Set before
+        playback starts; null (the default) meters nothing. */
+    void setOutputMeter (LevelMeter* meterToFeed) noexcept { outputMeter = meterToFeed; }
+
+    // Loads on the calling thread
     bool loadImpulseResponse (const juce::File& irFile);
+
+    // Decodes, resamples and partitions on a background thread, then swaps the new IR in.
+    // The callback runs on the message thread (or the loading thread if there is none).
+    using LoadCallback = std::function<void (const IRLoadHandle&)>;
+    std::shared_ptr<IRLoadHandle> loadImpulseResponseAsync (const juce::File& irFile, LoadCallback onComplete = {});
+
+    // True stereo from two stereo files, holding the responses to the left and the right input
+    std::shared_ptr<IRLoadHandle> loadTrueStereoImpulseResponseAsync (const juce::File& leftInputFile,
+                                                                      const juce::File& rightInputFile,
+                                                                      LoadCallback onComplete = {});
+
+    // Several IRs sharing one input transform, mixed by setBlendGain (partitioned algorithms only).
+    // Each IR is normalised on its own, so equal gains give equal loudness.
+    std::shared_ptr<IRLoadHandle> loadBlendAsync (const juce::Array<juce::File>& irFiles, LoadCallback onComplete = {});
+
+    // Several IRs interpolated in the frequency domain by setMorphPosition (partitioned algorithms only).
+    // Costs one convolution however many IRs there are; the JUCE algorithm plays the first.
+    std::shared_ptr<IRLoadHandle> loadMorphAsync (const juce::Array<juce::File>& irFiles, LoadCallback onComplete = {});
+    bool isLoadInProgress() const;
+
     bool loadImpulseResponseFromMemory (const void* data, size_t size);
     bool isIrLoaded() const noexcept { return irLoaded; }
     
@@ -23,6 +152,46 @@ public:
 
     void setIrResampleEnabled (bool enabled) noexcept { resampleIrToDevice.store(enabled); }
     bool isIrResampleEnabled() const noexcept { return resampleIrToDevice.load(); }
+
+    // Once the device rate has changed, each resampled load also builds the IR in the background
+    // for the rate before the change and the standard rates either side of the new one, retained
+    // by the IR cache, so prepareToPlay at one of them swaps partitions in instead of reloading.
+    // Sessions that never change rate build nothing extra. Applies from the next load.
+    static constexpr std::array<double, 4> variantSampleRates { 44100.0, 48000.0, 88200.0, 96000.0 };
+    void setRateVariantsEnabled (bool enabled) noexcept { rateVariantsEnabled.store (enabled); }
+    bool areRateVariantsEnabled() const noexcept { return rateVariantsEnabled.load(); }
+
+    // Windowed-sinc preset used when an IR is resampled to the device rate. Applies from the next load.
+    void setResamplerQuality (PolyphaseResampler::Quality quality) noexcept { resamplerQuality.store (quality); }
+    PolyphaseResampler::Quality getResamplerQuality() const noexcept { return resamplerQuality.load(); }
+
+    // Loaded IRs are cut where their decay curve falls floorDb below the total energy,
+    // or meets the recording's noise floor, then faded out. Applies from the next load.
+    static constexpr float defaultAutoTrimFloor = -60.0f;
+    static constexpr double autoTrimFadeSeconds = 0.01;
+    void setAutoTrimEnabled (bool enabled) noexcept { autoTrimEnabled.store (enabled); }
+    bool isAutoTrimEnabled() const noexcept { return autoTrimEnabled.load(); }
+    void setAutoTrimFloor (float floorDb) noexcept { autoTrimFloor.store (juce::jmin (-1.0f, floorDb)); }
+    float getAutoTrimFloor() const noexcept { return autoTrimFloor.load(); }
+
+    // Applies from the next load; the transform runs on the loading thread and its result is cached
+    void setIRTransform (IRTransform transform) noexcept { irTransform.store (transform); }
+    IRTransform getIRTransform() const noexcept { return irTransform.load(); }
+
+    // What the transform and trimming took off the last IR loaded
+    struct TrimReport
+    {
+        double secondsSaved = 0.0;
+        int partitionsSaved = 0;
+
+        // The part of the saving the transform made possible, and what it cost to run.
+        // Only known when the IR was processed rather than taken from the cache.
+        double transformSecondsSaved = 0.0;
+        int transformPartitionsSaved = 0;
+        double transformMs = 0.0;
+    };
+
+    TrimReport getTrimReport() const;
     
     // Deferred IR loading: Store IR to load on next prepareToPlay or processBlock
     void setDeferredIRLoad (const juce::File& irFile) noexcept { deferredIRFile = irFile; }
@@ -30,19 +199,244 @@ public:
     // Signal that we need to reset the convolver's buffers after IR load
     void signalIRChange() noexcept { needsReset.store(true); }
 
+    Algorithm getAlgorithm() const noexcept { return algorithm; }
+    ChannelRouting getChannelRouting() const noexcept { return channelRouting.load(); }
+
+    // Blend gains are kept across loads and ramp over blendRampSeconds when changed
+    static constexpr int maxBlendSources = 8;
+    static constexpr double blendRampSeconds = 0.05;
+    void setBlendGain (int source, float gain) noexcept;
+    float getBlendGain (int source) const noexcept;
+    int getNumBlendSources() const noexcept { return numBlendSources.load(); }
+
+    // 0 is the first IR of a morph, 1 the last; kept across loads
+    void setMorphPosition (float position) noexcept { morphPosition.store (juce::jlimit (0.0f, 1.0f, position)); }
+    float getMorphPosition() const noexcept { return morphPosition.load(); }
+    bool isMorphLoaded() const noexcept { return morphLoaded.load(); }
+
+    // The convolvers run in blocks of this size (rounded to a power of two) whatever the host
+    // sends, so host block size changes need no rebuild. The partitioned algorithm reports one
+    // internal block as latency. Applies from the next prepareToPlay.
+    static constexpr int defaultInternalBlockSize = 256;
+    void setInternalBlockSize (int numSamples) noexcept { internalBlockSize.store (juce::jmax (1, numSamples)); }
+    int getInternalBlockSize() const noexcept { return internalBlockSize.load(); }
+
+    // Exact delay of the output as it plays now: one internal block for the partitioned
+    // algorithm, none for zero latency or the JUCE one. After an algorithm change it moves
+    // to the new value only when the convolver built for it is swapped in, at the start of
+    // the crossfade. Bypassed and IR-less output is delayed to match.
+    int getLatencySamples() const noexcept { return playingLatency.load(); }
+
+    // Proportion of convolved signal (0 to 1, ramped); the dry part is delayed by the latency so the two line up
+    static constexpr double mixRampSeconds = 0.05;
+    void setMix (float wetProportion) noexcept { mix.store (juce::jlimit (0.0f, 1.0f, wetProportion)); }
+    float getMix() const noexcept { return mix.load(); }
+
+    // How long the output keeps ringing after the input stops, latency included
+    double getTailLengthSeconds() const noexcept { return tailSeconds.load(); }
+
+    // True while silent input has let the partitioned convolver stop working altogether
+    bool isSleeping() const noexcept { return sleeping.load(); }
+
+    const char* getKernelName() const noexcept { return kernels.name; }
+
+    IRCache::Stats getIRCacheStats() const { return irCache->getStats(); }
+
+    // How late IR segments are scheduled; applies from the next IR load or prepareToPlay
+    // (the partition layout, which grows towards worker-sized blocks, from the next IR load)
+    void setTailScheduling (PartitionedConvolver::Scheduling scheduling) noexcept { tailScheduling.store (scheduling); }
+    PartitionedConvolver::Scheduling getTailScheduling() const noexcept { return tailScheduling.load(); }
+
+    // Tail segment scheduling counters, for every engine sharing the pool (all zero when it has no threads)
+    ConvolutionWorkerPool::Stats getWorkerStats() const noexcept;
+
+    // Time spent convolving per processBlock call
+    struct BlockCost
+    {
+        double averageMs = 0.0;
+        double worstMs = 0.0;
+        juce::int64 numBlocks = 0;
+    };
+
+    BlockCost getBlockCost() const noexcept;
+    void resetBlockCost() noexcept { blockCostResetRequested.store (true); }
+
+    // Length of the crossfade when a newly loaded IR replaces the playing one
+    void setCrossfadeLength (double seconds) noexcept { crossfadeSeconds.store (juce::jmax (0.0, seconds)); }
+    double getCrossfadeLength() const noexcept { return crossfadeSeconds.load(); }
+    int getNumWorkerThreads() const noexcept { return workerPool->getNumThreads(); }
+
 private:
-    juce::dsp::Convolution convolver;
+    class ConvolverReclaimer;
+
+    // What the audio thread plays: a partitioned convolver, or a JUCE one for that algorithm.
+    // Either is built and prepared whole on the loading thread before it is published.
+    struct PublishedConvolver
+    {
+        std::unique_ptr<PartitionedConvolver> partitioned;
+        std::unique_ptr<juce::dsp::Convolution> uniform;
+
+        int getLatencySamples() const noexcept
+        {
+            return partitioned != nullptr ? partitioned->getLatencySamples() : uniform->getLatency();
+        }
+    };
+
+    // Snapshot of what prepareToPlay set up, taken when a load starts
+    struct LoadSettings
+    {
+        double sampleRate;
+        int blockSize;
+        Algorithm algorithm;
+        int headBlockSize;
+        bool resample;
+        PolyphaseResampler::Quality resamplerQuality;
+        bool autoTrim;
+        float autoTrimFloor;
+        IRTransform transform;
+        int numInputChannels;
+        int numOfflineSegments;
+        int workerBlockSize;        // Smallest segment the worker threads take, 0 if none will
+        int generation;
+    };
+
+    // What a load was built from: enough to rebuild it for other settings without the files
+    struct LoadedSource
+    {
+        juce::String contentHash;
+        double sampleRate = 0.0;    // The files' own rate
+        int channelsPerSource = 0;
+        int numSources = 1;
+        IRLoadHandle::Sources sources = IRLoadHandle::Sources::single;
+        std::shared_ptr<const juce::AudioBuffer<float>> decoded;   // Never modified, shared through the IR cache; nullptr until a build needs it
+        juce::String decodedKey;    // The files' hashes, shared by every load that decodes them the same way
+        int length = 0;             // In samples at the files' rate
+    };
+
+    LoadSettings getLoadSettings() const;
+    // Loads given a decoded source rebuild from it instead of reading the handle's files
+    std::shared_ptr<IRLoadHandle> startLoad (std::shared_ptr<IRLoadHandle> handle, LoadCallback onComplete,
+                                             LoadedSource rebuildFrom);
+    void finishLoadingForOfflineRender();
+    bool runLoad (IRLoadHandle& handle, const LoadedSource& rebuildFrom);
+    void startRateVariants (const LoadedSource& source, const LoadSettings& settings, double previousRate);
+    void buildRateVariants (IRLoadHandle& handle, LoadedSource source, LoadSettings settings, double previousRate);
+    // Fills in the source's decoded samples from its files unless another instance holds them; false if cancelled or unreadable
+    bool decodeSource (const juce::Array<juce::File>& files, LoadedSource& source, IRLoadHandle& handle);
+    bool swapInCachedPartitions();
+    IRCache::ChannelIRs partitionImpulseResponse (const juce::AudioBuffer<float>& irBuffer,
+                                                  const LoadSettings& settings,
+                                                  int channelsPerSource,
+                                                  IRLoadHandle& handle);
+    std::unique_ptr<PartitionedConvolver> createPartitionedConvolver (const IRCache::ChannelIRs& channelIRs,
+                                                                      const LoadSettings& settings,
+                                                                      IRLoadHandle::Sources sources,
+                                                                      int numSources);
+    std::unique_ptr<juce::dsp::Convolution> createUniformConvolver (juce::AudioBuffer<float>&& irBuffer, double irSampleRate,
+                                                                    const LoadSettings& settings);
+    static void prepareUniformConvolver (juce::dsp::Convolution& uniform, double sampleRate, int blockSize);
+    static ChannelRouting chooseRouting (int numIRChannels, int numInputChannels) noexcept;
+    static IRCache::Key makeCacheKey (const juce::String& contentHash, double irSampleRate, const LoadSettings& settings);
+    static IRCache::Key makeCacheKey (const LoadedSource& source, const LoadSettings& settings);
+    static int getLatencyFor (Algorithm algorithmToUse, int headBlockSizeToUse) noexcept;
+    static int getNumPartitionsFor (int irLength, const LoadSettings& settings);
+    template <typename SampleType> void processSamples (juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType> void convolveBlock (juce::AudioBuffer<SampleType>& buffer) noexcept;
+    template <typename SampleType> void runConvolver (PublishedConvolver& published, juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept;
+    template <typename SampleType> void processUniform (juce::dsp::Convolution& uniform, juce::AudioBuffer<SampleType>& buffer) noexcept;
+    template <typename SampleType> void delayDry (juce::AudioBuffer<SampleType>& dryBuffer, int numChannels, int numSamples) noexcept;
+    void pickUpPendingConvolver() noexcept;
+    void recordBlockCost (juce::int64 ticks) noexcept;
+
+    SimdKernels::KernelTable kernels;
+    Algorithm algorithm = Algorithm::nonUniformPartitioned;
+    int headBlockSize = 512;
+    std::atomic<int> internalBlockSize { defaultInternalBlockSize };
+    int numInputChannels = 2;
+    std::atomic<ChannelRouting> channelRouting { ChannelRouting::perChannel };
+    std::array<std::atomic<float>, maxBlendSources> blendGains;
+    std::atomic<int> numBlendSources { 0 };
+    std::atomic<float> morphPosition { 0.0f };
+    std::atomic<bool> morphLoaded { false };
+
+    // Partitioned IRs shared with every other engine in the process
+    juce::SharedResourcePointer<IRCache> irCache;
+
+    // Runs the late tail segments for every engine in the process; declared first so it outlives every convolver using it
+    juce::SharedResourcePointer<ConvolutionWorkerPool> workerPool;
+    std::atomic<PartitionedConvolver::Scheduling> tailScheduling { PartitionedConvolver::Scheduling::workerThreads };
+    std::atomic<bool> offlineMultithreaded { true };
+
+    // Written by the audio thread only, reset on request
+    std::atomic<juce::int64> blockCostTotalTicks { 0 };
+    std::atomic<juce::int64> blockCostWorstTicks { 0 };
+    std::atomic<juce::int64> numTimedBlocks { 0 };
+    std::atomic<bool> blockCostResetRequested { false };
+
+    // Diagnostics posted from processBlock
+    AudioLogger audioLog;
+    LevelMeter* outputMeter = nullptr;
+
+    // Deletes convolvers the audio thread has finished with; outlives them, but not the worker pool
+    std::unique_ptr<ConvolverReclaimer> reclaimer;
+
+    // Convolvers are built on the loading thread and published through pendingConvolver.
+    // processBlock takes ownership and crossfades from the playing one, which is then reclaimed.
+    // The playing one keeps its latency after prepareToPlay changes the algorithm, until its
+    // replacement arrives and the latency moves over in the same crossfade.
+    std::unique_ptr<PublishedConvolver> playingConvolver;
+    std::unique_ptr<PublishedConvolver> fadingOutConvolver;
+    std::atomic<PublishedConvolver*> pendingConvolver { nullptr };
+    std::atomic<int> playingLatency { 0 };
+    int fadingOutLatency = 0;
+    std::tuple<juce::AudioBuffer<float>, juce::AudioBuffer<double>> crossfadeBuffers;   // One per sample type
+    juce::AudioBuffer<float> juceConversionBuffer;   // Double blocks on the JUCE algorithm
+
+    // The dry signal runs through a ring a headBlockSize chunk at a time. It is read back at the
+    // playing latency, and during a crossfade at the faded-out one's too, ramped like the wet signal.
+    std::tuple<juce::AudioBuffer<float>, juce::AudioBuffer<double>> dryDelayLines;
+    std::tuple<juce::AudioBuffer<float>, juce::AudioBuffer<double>> dryBuffers;
+    int dryDelayPosition = 0;
+    std::atomic<float> mix { 1.0f };
+    juce::SmoothedValue<float> mixRamp { 1.0f };
+    std::atomic<double> crossfadeSeconds { 0.05 };
+    int crossfadeLength = 0;
+    int crossfadeRemaining = 0;
+
+    // Input that has been silent for the whole tail leaves nothing to compute until signal returns
+    juce::int64 silentInputSamples = 0;
+    std::atomic<bool> sleeping { false };
+    std::atomic<double> tailSeconds { 0.0 };
+
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
     double lastPreparedSampleRate = 0.0;
-    int lastPreparedBlockSize = 0;
+    double previousSampleRate = 0.0;   // The rate before the last change, 0 until one; guarded by loadLock
     std::atomic<bool> irLoaded { false }; // Indicates if an impulse response is loaded
     std::atomic<bool> bypass { false }; // Bypass convolution processing
     std::atomic<bool> isPrepared { false }; // Flag: convolver is already prepared
     std::atomic<bool> needsReset { false }; // Flag: reset convolver buffers on next processBlock
     std::atomic<bool> resampleIrToDevice { true }; // Resample IR to device sample rate on load
+    std::atomic<PolyphaseResampler::Quality> resamplerQuality { PolyphaseResampler::Quality::balanced };
+    std::atomic<bool> rateVariantsEnabled { true };
+    std::atomic<bool> autoTrimEnabled { true };
+    std::atomic<float> autoTrimFloor { defaultAutoTrimFloor };
+    std::atomic<IRTransform> irTransform { IRTransform::none };
+    TrimReport trimReport;  // Guarded by loadLock
     juce::String lastLoadedIRPath; // Track which IR is loaded to prevent reloading same file
+    juce::Array<juce::File> lastLoadedFiles; // Every file of the last load, for rebuilding it
+    IRLoadHandle::Sources lastLoadedSources = IRLoadHandle::Sources::single;
+    LoadedSource lastLoadedSource;
     juce::File deferredIRFile; // IR to load after prepareToPlay is called
 
+    // Guards the load settings, lastLoadedIRPath and currentLoad between prepareToPlay and loader threads
+    juce::CriticalSection loadLock;
+    std::shared_ptr<IRLoadHandle> currentLoad;
+    std::shared_ptr<IRLoadHandle> currentRateVariants;   // Cancelled by the next load
+    int settingsGeneration = 0;
+
+    // Declared last so it is stopped before anything its jobs use is destroyed
+    juce::ThreadPool loadPool { 1 };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionEngine)
 };
@@ -0,0 +1,211 @@
+#include "ConvolutionWorkerPool.h"
+
+//==============================================================================
+class ConvolutionWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker (ConvolutionWorkerPool& ownerPool, int index)
+        : juce::Thread ("Convolution worker " + juce::String (index)),
+          owner (ownerPool)
+    {
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            // Keep draining the queue, then poll: the audio thread never signals
+            if (! owner.runNextQueuedTask())
+                wait (owner.numTasks.load (std::memory_order_relaxed) > 0 ? pollIntervalMs : -1);
+        }
+    }
+
+private:
+    ConvolutionWorkerPool& owner;
+};
+
+//==============================================================================
+ConvolutionWorkerPool::ConvolutionWorkerPool()
+    : ConvolutionWorkerPool (juce::jlimit (0, maxSharedThreads, juce::SystemStats::getNumPhysicalCpus() - 1), maxSharedTasks)
+{
+}
+
+ConvolutionWorkerPool::ConvolutionWorkerPool (int numThreads, int maxTasks)
+    : slots (new Slot[(size_t) maxTasks]),
+      numSlots (maxTasks)
+{
+    for (int i = 0; i < numThreads; ++i)
+    {
+        auto* worker = workers.add (new Worker (*this, i));
+        worker->startThread (juce::Thread::Priority::high);
+    }
+
+    juce::Logger::writeToLog ("Convolution worker pool started with " + juce::String (numThreads) + " threads");
+}
+
+ConvolutionWorkerPool::~ConvolutionWorkerPool()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->notify();
+    }
+
+    for (auto* worker : workers)
+        worker->stopThread (1000);
+
+    // Every task should have been removed by its owner before the pool goes away
+    for (int i = 0; i < numSlots; ++i)
+        jassert (slots[i].state.load() == unused);
+}
+
+int ConvolutionWorkerPool::addTask (Task* task)
+{
+    jassert (task != nullptr);
+    int slot = -1;
+
+    {
+        const juce::ScopedLock sl (slotAllocationLock);
+
+        for (int i = 0; i < numSlots; ++i)
+        {
+            if (slots[i].state.load() == unused)
+            {
+                slots[i].task.store (task);
+                slots[i].state.store (idle);
+                slotsInUseEnd.store (juce::jmax (slotsInUseEnd.load(), i + 1));
+                slot = i;
+                break;
+            }
+        }
+    }
+
+    // Sleeping workers start polling again
+    if (slot >= 0 && numTasks.fetch_add (1) == 0)
+        for (auto* worker : workers)
+            worker->notify();
+
+    return slot;
+}
+
+void ConvolutionWorkerPool::removeTask (int slot)
+{
+    if (! juce::isPositiveAndBelow (slot, numSlots))
+        return;
+
+    auto& s = slots[slot];
+
+    // Withdraw it if still queued, otherwise wait for a running worker to let go of it
+    for (;;)
+    {
+        int expected = queued;
+        if (s.state.compare_exchange_strong (expected, idle) || expected != running)
+            break;
+
+        juce::Thread::yield();
+    }
+
+    const juce::ScopedLock sl (slotAllocationLock);
+    s.task.store (nullptr);
+    s.state.store (unused);
+    numTasks.fetch_sub (1);
+}
+
+void ConvolutionWorkerPool::waitForTask (int slot) noexcept
+{
+    auto& s = slots[slot];
+    int expected = queued;
+
+    if (s.state.compare_exchange_strong (expected, running, std::memory_order_acquire))
+    {
+        runInline (s);
+        return;
+    }
+
+    while (s.state.load (std::memory_order_acquire) == running)
+        juce::Thread::yield();
+
+    if (s.state.load (std::memory_order_relaxed) == finished)
+        s.state.store (idle, std::memory_order_relaxed);
+}
+
+void ConvolutionWorkerPool::submit (int slot) noexcept
+{
+    auto& s = slots[slot];
+    jassert (s.state.load() == idle);
+
+    s.state.store (queued, std::memory_order_release);
+    tasksSubmitted.fetch_add (1, std::memory_order_relaxed);
+}
+
+bool ConvolutionWorkerPool::collect (int slot, bool resultIsDue) noexcept
+{
+    auto& s = slots[slot];
+    const int state = s.state.load (std::memory_order_acquire);
+
+    if (state == idle)
+        return true;
+
+    if (state == finished)
+    {
+        s.state.store (idle, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (! resultIsDue)
+        return false;
+
+    deadlineMisses.fetch_add (1, std::memory_order_relaxed);
+
+    // Nobody has started it - run it here rather than wait for a worker to wake up
+    int expected = queued;
+    if (s.state.compare_exchange_strong (expected, running, std::memory_order_acquire))
+    {
+        runInline (s);
+        return true;
+    }
+
+    // A worker has it, and the audio thread does not wait for anyone
+    resultsDropped.fetch_add (1, std::memory_order_relaxed);
+    return false;
+}
+
+void ConvolutionWorkerPool::runInline (Slot& s) noexcept
+{
+    s.task.load (std::memory_order_relaxed)->run();
+    tasksRunInline.fetch_add (1, std::memory_order_relaxed);
+    s.state.store (idle, std::memory_order_release);
+}
+
+bool ConvolutionWorkerPool::runNextQueuedTask() noexcept
+{
+    const int end = slotsInUseEnd.load (std::memory_order_relaxed);
+
+    for (int i = 0; i < end; ++i)
+    {
+        auto& s = slots[i];
+        int expected = queued;
+
+        if (s.state.load (std::memory_order_relaxed) == queued
+            && s.state.compare_exchange_strong (expected, running, std::memory_order_acquire))
+        {
+            s.task.load (std::memory_order_relaxed)->run();
+            tasksCompletedByWorkers.fetch_add (1, std::memory_order_relaxed);
+            s.state.store (finished, std::memory_order_release);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ConvolutionWorkerPool::Stats ConvolutionWorkerPool::getStats() const noexcept
+{
+    Stats stats;
+    stats.tasksSubmitted = tasksSubmitted.load (std::memory_order_relaxed);
+    stats.tasksCompletedByWorkers = tasksCompletedByWorkers.load (std::memory_order_relaxed);
+    stats.deadlineMisses = deadlineMisses.load (std::memory_order_relaxed);
+    stats.tasksRunInline = tasksRunInline.load (std::memory_order_relaxed);
+    stats.resultsDropped = resultsDropped.load (std::memory_order_relaxed);
+    return stats;
+}
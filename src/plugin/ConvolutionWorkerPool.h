@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+/**
+ * Background threads that run convolution work handed over by the audio thread.
+ *
+ * Plugin instances share one pool through juce::SharedResourcePointer, so the
+ * number of threads stays the same however many instances are open.
+ *
+ * Work is registered up front in fixed slots (off the audio thread). The audio
+ * thread then only flips atomic slot states and never blocks: submit() queues a
+ * slot without signalling anyone, since workers poll for queued slots every
+ * millisecond while any task is registered (and sleep while none is), and
+ * collect() only checks whether the slot has finished. When the result is due,
+ * a task no worker has started is run inline; one a worker is still running is
+ * left to it and counted as dropped. Both count as missed deadlines.
+ */
+class ConvolutionWorkerPool
+{
+public:
+    struct Task
+    {
+        virtual ~Task() = default;
+        virtual void run() noexcept = 0;
+    };
+
+    struct Stats
+    {
+        juce::int64 tasksSubmitted = 0;
+        juce::int64 tasksCompletedByWorkers = 0;
+        juce::int64 deadlineMisses = 0;     // Results not ready when the audio thread needed them
+        juce::int64 tasksRunInline = 0;     // Misses the audio thread computed itself
+        juce::int64 resultsDropped = 0;     // Misses a worker was still running, so nothing was added
+    };
+
+    // The shared pool: one thread per physical core but one, up to maxSharedThreads
+    ConvolutionWorkerPool();
+    explicit ConvolutionWorkerPool (int numThreads, int maxTasks = 256);
+    ~ConvolutionWorkerPool();
+
+    static constexpr int maxSharedThreads = 4;
+    static constexpr int maxSharedTasks = 1024;
+
+    // Off the audio thread. Returns -1 if every slot is in use.
+    int addTask (Task* task);
+
+    // Off the audio thread. Waits for the task to finish if a worker is running it.
+    void removeTask (int slot);
+
+    // Off the audio thread (offline renders, resets): blocks until the task has finished,
+    // running it here if no worker has picked it up
+    void waitForTask (int slot) noexcept;
+
+    // Audio thread; never waits
+    void submit (int slot) noexcept;
+
+    /** Audio thread; never waits. True once the task has finished (or was never submitted),
+        after which the slot can be submitted again. With resultIsDue, a task still queued
+        is run here instead, and one a worker is running is counted as dropped. */
+    bool collect (int slot, bool resultIsDue) noexcept;
+
+    int getNumThreads() const noexcept { return workers.size(); }
+    Stats getStats() const noexcept;
+
+private:
+    enum SlotState { unused, idle, queued, running, finished };
+
+    struct Slot
+    {
+        std::atomic<Task*> task { nullptr };
+        std::atomic<int> state { unused };
+    };
+
+    class Worker;
+
+    bool runNextQueuedTask() noexcept;
+    void runInline (Slot& slot) noexcept;
+
+    static constexpr int pollIntervalMs = 1;
+
+    std::unique_ptr<Slot[]> slots;
+    const int numSlots;
+    std::atomic<int> slotsInUseEnd { 0 };   // One past the highest slot ever handed out
+    std::atomic<int> numTasks { 0 };
+    juce::CriticalSection slotAllocationLock;
+    juce::OwnedArray<Worker> workers;
+
+    std::atomic<juce::int64> tasksSubmitted { 0 };
+    std::atomic<juce::int64> tasksCompletedByWorkers { 0 };
+    std::atomic<juce::int64> deadlineMisses { 0 };
+    std::atomic<juce::int64> tasksRunInline { 0 };
+    std::atomic<juce::int64> resultsDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionWorkerPool)
+};
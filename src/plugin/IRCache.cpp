@@ -0,0 +1,459 @@
+#include "IRCache.h"
+#include "../common/Constants.h"
+
+namespace
+{
+    // Partition file: header, the full cache key, segment table, then per channel the FIR head
+    // and the spectra, each starting on a dataAlignment boundary so mapped floats stay SIMD friendly.
+    // Files are only read back on the machine that wrote them, so native byte order is fine.
+    constexpr char partitionFileMagic[4] = { 'C', 'D', 'P', 'C' };
+    constexpr juce::int32 partitionFileVersion = 2;
+    constexpr size_t dataAlignment = 64;
+    constexpr int maxFileBlockSize = 1 << 20;
+
+    struct PartitionFileHeader
+    {
+        char magic[4];
+        juce::int32 version;
+        juce::int32 numChannels;
+        juce::int32 headBlockSize;
+        juce::int32 irLength;
+        juce::int32 directHeadLength;
+        juce::int32 numSegments;
+        juce::int32 keyLength;      // UTF-8 bytes of Key::toString() following the header
+    };
+
+    struct PartitionFileSegment
+    {
+        juce::int32 blockSize;
+        juce::int32 offset;
+        juce::int32 numPartitions;
+    };
+
+    size_t alignUp (size_t size) noexcept
+    {
+        return (size + dataAlignment - 1) & ~(dataAlignment - 1);
+    }
+
+    bool writePadding (juce::OutputStream& out)
+    {
+        const auto position = (size_t) out.getPosition();
+        return out.writeRepeatedByte (0, alignUp (position) - position);
+    }
+
+    // Faults every page of a fresh mapping in, so the audio thread never waits on the disk for it
+    void touchPages (const char* data, size_t size) noexcept
+    {
+        constexpr size_t pageSize = 4096;
+        volatile char sink = 0;
+
+        for (size_t i = 0; i < size; i += pageSize)
+            sink = sink + data[i];
+
+        juce::ignoreUnused (sink);
+    }
+}
+
+IRCache::IRCache()
+    : diskDirectory (juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                        .getChildFile (CanDamonium::DEFAULT_PARTITION_CACHE_FOLDER))
+{
+}
+
+void IRCache::setDiskDirectory (const juce::File& directory)
+{
+    const juce::ScopedLock sl (lock);
+    diskDirectory = directory;
+}
+
+juce::File IRCache::getDiskDirectory() const
+{
+    const juce::ScopedLock sl (lock);
+    return diskDirectory;
+}
+
+juce::String IRCache::Key::toString() const
+{
+    return contentHash + "_" + juce::String (sampleRate, 1)
+         + "_h" + juce::String (headBlockSize) + "_m" + juce::String (maxBlockSize)
+         + "_l" + juce::String (latencySamples) + "_d" + juce::String (directHeadLength)
+         + (numUniformSegments > 0 ? "_u" + juce::String (numUniformSegments) : juce::String())
+         + (offloadBlockSize > 0 ? "_o" + juce::String (offloadBlockSize) : juce::String());
+}
+
+IRCache::ChannelIRs IRCache::find (const Key& key)
+{
+    const auto name = key.toString();
+    juce::File file;
+
+    {
+        const juce::ScopedLock sl (lock);
+        const auto it = entries.find (name);
+
+        if (it != entries.end())
+        {
+            auto channels = lockEntry (it->second);
+
+            if (! channels.empty())
+            {
+                ++hits;
+                return channels;
+            }
+
+            entries.erase (it);
+        }
+
+        file = getDiskFile (key);
+    }
+
+    // Opening, checking and paging in a file can take a while, so other instances keep the cache meanwhile
+    auto channels = readFromDisk (key, file);
+
+    const juce::ScopedLock sl (lock);
+
+    if (channels.empty())
+    {
+        ++misses;
+        return {};
+    }
+
+    // Another instance may have mapped or built the same entry in the meantime: share its copy
+    auto& entry = entries[name];
+
+    if (auto existing = lockEntry (entry); ! existing.empty())
+    {
+        ++hits;
+        return existing;
+    }
+
+    entry.assign (channels.begin(), channels.end());
+    ++diskHits;
+    return channels;
+}
+
+IRCache::ChannelIRs IRCache::insert (const Key& key, ChannelIRs channels)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        removeExpiredEntries();
+
+        auto& entry = entries[key.toString()];
+        auto existing = lockEntry (entry);
+
+        if (! existing.empty())
+            return existing;
+
+        entry.assign (channels.begin(), channels.end());
+    }
+
+    // Writing takes a while for long IRs, so other instances can keep hitting the memory cache meanwhile
+    writeToDisk (key, channels);
+    return channels;
+}
+
+IRCache::DecodedIR IRCache::findDecoded (const juce::String& contentHash)
+{
+    const juce::ScopedLock sl (lock);
+    const auto it = decodedEntries.find (contentHash);
+    return it != decodedEntries.end() ? it->second.lock() : nullptr;
+}
+
+IRCache::DecodedIR IRCache::insertDecoded (const juce::String& contentHash, DecodedIR decoded)
+{
+    const juce::ScopedLock sl (lock);
+
+    for (auto it = decodedEntries.begin(); it != decodedEntries.end();)
+        it = it->second.expired() ? decodedEntries.erase (it) : std::next (it);
+
+    auto& entry = decodedEntries[contentHash];
+
+    if (auto existing = entry.lock())
+        return existing;
+
+    entry = decoded;
+    return decoded;
+}
+
+void IRCache::retain (const Key& key, const ChannelIRs& channels)
+{
+    const juce::ScopedLock sl (lock);
+    const auto name = key.toString();
+
+    retained.remove_if ([&name] (const auto& entry) { return entry.first == name; });
+    retained.emplace_front (name, channels);
+
+    // The newest entry always stays, even on its own over the limit
+    size_t numBytes = 0;
+
+    for (auto it = retained.begin(); it != retained.end();)
+    {
+        for (const auto& channel : it->second)
+            numBytes += channel->getMemorySize();
+
+        if (numBytes > maxRetainedBytes && it != retained.begin())
+            it = retained.erase (it);
+        else
+            ++it;
+    }
+}
+
+IRCache::Stats IRCache::getStats()
+{
+    const juce::ScopedLock sl (lock);
+    removeExpiredEntries();
+
+    Stats stats;
+    stats.numEntries = (int) entries.size();
+    stats.hits = hits;
+    stats.diskHits = diskHits;
+    stats.misses = misses;
+
+    for (const auto& entry : entries)
+        for (const auto& channel : lockEntry (entry.second))
+            stats.numBytes += channel->getMemorySize();
+
+    for (const auto& entry : retained)
+        for (const auto& channel : entry.second)
+            stats.numRetainedBytes += channel->getMemorySize();
+
+    return stats;
+}
+
+IRCache::ChannelIRs IRCache::lockEntry (const std::vector<std::weak_ptr<const PartitionedIR>>& entry) const
+{
+    ChannelIRs channels;
+
+    for (const auto& weak : entry)
+    {
+        auto channel = weak.lock();
+
+        if (channel == nullptr)
+            return {};
+
+        channels.push_back (std::move (channel));
+    }
+
+    return channels;
+}
+
+void IRCache::removeExpiredEntries()
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (lockEntry (it->second).empty())
+            it = entries.erase (it);
+        else
+            ++it;
+    }
+}
+
+//==============================================================================
+juce::File IRCache::getDiskFile (const Key& key) const
+{
+    if (diskDirectory == juce::File())
+        return {};
+
+    return diskDirectory.getChildFile (key.toString() + ".cdpc");
+}
+
+IRCache::ChannelIRs IRCache::readFromDisk (const Key& key, const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return {};
+
+    auto mapped = std::make_shared<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*> (mapped->getData());
+    const auto size = mapped->getSize();
+
+    auto reject = [&file] (const juce::String& reason)
+    {
+        juce::Logger::writeToLog ("  Ignoring partition cache file " + file.getFileName() + ": " + reason);
+        file.deleteFile();
+        return ChannelIRs();
+    };
+
+    if (data == nullptr || size < sizeof (PartitionFileHeader))
+        return reject ("unreadable");
+
+    PartitionFileHeader header;
+    std::memcpy (&header, data, sizeof (header));
+    const auto keyText = key.toString().toStdString();
+
+    if (std::memcmp (header.magic, partitionFileMagic, sizeof (partitionFileMagic)) != 0
+         || header.version != partitionFileVersion
+         || header.numChannels <= 0
+         || header.numSegments < 0
+         || header.irLength <= 0
+         || header.headBlockSize != key.headBlockSize
+         || header.directHeadLength != key.directHeadLength
+         || header.keyLength != (juce::int32) keyText.size())
+        return reject ("header mismatch");
+
+    // Every field of the key, not just those the layout repeats, has to match the one asked for
+    size_t position = sizeof (header);
+
+    if ((juce::uint64) size < (juce::uint64) position + keyText.size() + (juce::uint64) header.numSegments * sizeof (PartitionFileSegment))
+        return reject ("truncated");
+
+    if (std::memcmp (data + position, keyText.data(), keyText.size()) != 0)
+        return reject ("key mismatch");
+
+    position += keyText.size();
+
+    PartitionLayout layout;
+    layout.headBlockSize = header.headBlockSize;
+    layout.irLength = header.irLength;
+    layout.directHeadLength = header.directHeadLength;
+
+    // Segments have to tile the IR after the FIR head, so their sizes are bounded by the IR length
+    juce::int64 expectedOffset = layout.directHeadLength;
+
+    for (int s = 0; s < header.numSegments; ++s)
+    {
+        PartitionFileSegment segment;
+        std::memcpy (&segment, data + position, sizeof (segment));
+        position += sizeof (segment);
+
+        if (! juce::isPowerOfTwo (segment.blockSize)
+             || segment.blockSize > juce::jmin (maxFileBlockSize, key.maxBlockSize)
+             || segment.offset != expectedOffset
+             || segment.numPartitions <= 0
+             || segment.numPartitions > header.irLength / segment.blockSize + 1)
+            return reject ("bad segment table");
+
+        expectedOffset += (juce::int64) segment.numPartitions * segment.blockSize;
+        layout.segments.push_back ({ segment.blockSize, segment.offset, segment.numPartitions });
+    }
+
+    if (expectedOffset < juce::jmax (header.irLength, header.directHeadLength)
+         || (key.numUniformSegments > 0 && header.numSegments > key.numUniformSegments))
+        return reject ("bad segment table");
+
+    const auto headBytes = (juce::uint64) layout.directHeadLength * sizeof (float);
+    const auto spectraBytes = (juce::uint64) PartitionedIR::getSpectraSize (layout) * sizeof (float);
+    position = alignUp (position);
+
+    if ((juce::uint64) size < (juce::uint64) position + (juce::uint64) header.numChannels * (alignUp (headBytes) + alignUp (spectraBytes)))
+        return reject ("truncated");
+
+    ChannelIRs channels;
+
+    for (int ch = 0; ch < header.numChannels; ++ch)
+    {
+        const auto* head = reinterpret_cast<const float*> (data + position);
+        position = alignUp (position + headBytes);
+        const auto* spectra = reinterpret_cast<const float*> (data + position);
+        position = alignUp (position + spectraBytes);
+
+        channels.push_back (std::make_shared<const PartitionedIR> (layout, head, spectra, mapped));
+    }
+
+    touchPages (data, position);
+
+    // Trimming drops the least recently used files first
+    file.setLastAccessTime (juce::Time::getCurrentTime());
+
+    juce::Logger::writeToLog ("  Mapped partition cache file " + file.getFileName()
+                              + " (" + juce::File::descriptionOfSizeInBytes ((juce::int64) size) + ")");
+    return channels;
+}
+
+void IRCache::writeToDisk (const Key& key, const ChannelIRs& channels) const
+{
+    const auto file = getDiskFile (key);
+
+    if (file == juce::File() || file.existsAsFile() || channels.empty())
+        return;
+
+    if (! file.getParentDirectory().createDirectory())
+    {
+        juce::Logger::writeToLog ("  Cannot create partition cache folder " + file.getParentDirectory().getFullPathName());
+        return;
+    }
+
+    const auto& layout = channels.front()->getLayout();
+
+    PartitionFileHeader header;
+    std::memcpy (header.magic, partitionFileMagic, sizeof (partitionFileMagic));
+    header.version = partitionFileVersion;
+    header.numChannels = (juce::int32) channels.size();
+    header.headBlockSize = layout.headBlockSize;
+    header.irLength = layout.irLength;
+    header.directHeadLength = layout.directHeadLength;
+    header.numSegments = (juce::int32) layout.segments.size();
+    const auto keyText = key.toString().toStdString();
+    header.keyLength = (juce::int32) keyText.size();
+
+    // Written beside the target and moved into place, so a reader never maps a half-written file
+    juce::TemporaryFile temp (file);
+    bool ok = false;
+
+    if (auto out = temp.getFile().createOutputStream())
+    {
+        ok = out->write (&header, sizeof (header))
+          && out->write (keyText.data(), keyText.size());
+
+        for (const auto& segment : layout.segments)
+        {
+            const PartitionFileSegment entry { segment.blockSize, segment.offset, segment.numPartitions };
+            ok = ok && out->write (&entry, sizeof (entry));
+        }
+
+        ok = ok && writePadding (*out);
+
+        for (const auto& channel : channels)
+        {
+            ok = ok && out->write (channel->getDirectHeadTaps(), (size_t) layout.directHeadLength * sizeof (float))
+                    && writePadding (*out)
+                    && out->write (channel->getSpectra(), PartitionedIR::getSpectraSize (layout) * sizeof (float))
+                    && writePadding (*out);
+        }
+
+        out->flush();
+        ok = ok && out->getStatus().wasOk();
+    }
+
+    if (ok && temp.overwriteTargetFileWithTemporary())
+    {
+        juce::Logger::writeToLog ("  Wrote partition cache file " + file.getFileName());
+        trimDiskDirectory (key.contentHash);
+    }
+    else
+    {
+        juce::Logger::writeToLog ("  Could not write partition cache file " + file.getFullPathName());
+    }
+}
+
+void IRCache::trimDiskDirectory (const juce::String& contentHash) const
+{
+    auto files = diskDirectory.findChildFiles (juce::File::findFiles, false, "*.cdpc");
+
+    std::sort (files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+    {
+        return a.getLastAccessTime() > b.getLastAccessTime();
+    });
+
+    // Names are the key, so a file of this IR is its hash followed by a rate: hashes never hold a '.'
+    const auto isFileOf = [prefix = contentHash + "_"] (const juce::File& file)
+    {
+        const auto name = file.getFileName();
+        const auto rate = name.fromFirstOccurrenceOf (prefix, false, false).upToFirstOccurrenceOf ("_", false, false);
+        return name.startsWith (prefix) && rate.containsChar ('.') && rate.containsOnly ("0123456789.");
+    };
+
+    juce::int64 totalBytes = 0;
+    int numFilesOfIR = 0;
+
+    for (const auto& file : files)
+    {
+        const auto size = file.getSize();
+        const bool tooMany = isFileOf (file) && ++numFilesOfIR > maxDiskFilesPerIR;
+        const bool tooBig = ! tooMany && totalBytes + size > maxDiskBytes;
+
+        // Files still mapped by a running instance may refuse to go on some systems; they are retried next time
+        if ((tooMany || tooBig) && file.deleteFile())
+            juce::Logger::writeToLog ("  Removed old partition cache file " + file.getFileName());
+        else
+            totalBytes += size;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include "PartitionedConvolver.h"
+
+/**
+ * Process-wide cache of partitioned impulse responses.
+ *
+ * Every plugin instance in the process reaches the same cache through a
+ * juce::SharedResourcePointer. Entries are keyed by file content, target sample
+ * rate and partition layout, and hold only weak references: the spectra live
+ * exactly as long as some convolver is using them.
+ *
+ * Behind the in-memory entries sits a directory of partition files. A memory
+ * miss maps the matching file read-only and wraps it without copying, so a
+ * session full of instances can reopen without decoding, resampling or FFTs.
+ * The directory is trimmed to maxDiskBytes, and each IR to maxDiskFilesPerIR files
+ * (its rates and layouts), least recently used files first.
+ *
+ * Entries can also be retained: up to maxRetainedBytes of them are held alive with
+ * no convolver using them, least recently retained dropped first. Engines retain
+ * the variants of their IR at other sample rates, so a rate change finds them here.
+ *
+ * Decoded IR files are shared the same way, keyed by content, so instances playing
+ * one IR keep a single copy to rebuild from.
+ */
+class IRCache
+{
+public:
+    struct Key
+    {
+        juce::String contentHash;   // MD5 of the IR file
+        double sampleRate = 0.0;    // Rate the IR was resampled to, or its own rate
+        int headBlockSize = 0;
+        int maxBlockSize = 0;
+        int latencySamples = 0;
+        int directHeadLength = 0;
+        int numUniformSegments = 0;   // Offline layouts: equal runs of headBlockSize partitions; 0 for non-uniform
+        int offloadBlockSize = 0;     // Non-uniform layouts grown for worker threads taking blocks this large; 0 if not
+
+        juce::String toString() const;
+    };
+
+    using ChannelIRs = std::vector<std::shared_ptr<const PartitionedIR>>;
+    using DecodedIR = std::shared_ptr<const juce::AudioBuffer<float>>;
+
+    struct Stats
+    {
+        int numEntries = 0;
+        size_t numBytes = 0;
+        juce::int64 hits = 0;
+        juce::int64 diskHits = 0;
+        juce::int64 misses = 0;
+        size_t numRetainedBytes = 0;
+    };
+
+    IRCache();
+
+    // Pass an invalid File to keep partitions in memory only
+    void setDiskDirectory (const juce::File& directory);
+    juce::File getDiskDirectory() const;
+
+    // Returns the cached channels, or an empty vector if nothing alive matches
+    ChannelIRs find (const Key& key);
+
+    // Stores freshly built channels and writes them to disk. If another instance got
+    // there first its channels are returned instead, so both end up sharing one copy.
+    ChannelIRs insert (const Key& key, ChannelIRs channels);
+
+    // The decoded files some engine still holds, or nullptr. Insert returns an earlier copy if there is one.
+    DecodedIR findDecoded (const juce::String& contentHash);
+    DecodedIR insertDecoded (const juce::String& contentHash, DecodedIR decoded);
+
+    // Keeps the channels alive until newer retained entries push them past maxRetainedBytes
+    void retain (const Key& key, const ChannelIRs& channels);
+
+    Stats getStats();
+
+private:
+    ChannelIRs lockEntry (const std::vector<std::weak_ptr<const PartitionedIR>>& entry) const;
+    void removeExpiredEntries();
+
+    juce::File getDiskFile (const Key& key) const;
+    static ChannelIRs readFromDisk (const Key& key, const juce::File& file);
+    void writeToDisk (const Key& key, const ChannelIRs& channels) const;
+    void trimDiskDirectory (const juce::String& contentHash) const;
+
+    static constexpr juce::int64 maxDiskBytes = 1024 * 1024 * 1024;
+    static constexpr int maxDiskFilesPerIR = 8;
+    static constexpr size_t maxRetainedBytes = 256 * 1024 * 1024;
+
+    juce::CriticalSection lock;
+    std::map<juce::String, std::vector<std::weak_ptr<const PartitionedIR>>> entries;
+    std::list<std::pair<juce::String, ChannelIRs>> retained;   // Most recently retained first
+    std::map<juce::String, std::weak_ptr<const juce::AudioBuffer<float>>> decodedEntries;
+    juce::File diskDirectory;
+    juce::int64 hits = 0;
+    juce::int64 diskHits = 0;
+    juce::int64 misses = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IRCache)
+};
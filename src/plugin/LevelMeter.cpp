@@ -0,0 +1,271 @@
+#include "LevelMeter.h"
+#include <cstring>
+
+namespace
+{
+    // Zeroth-order modified Bessel function of the first kind, by its power series
+    double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        const double quarterSquare = 0.25 * x * x;
+
+        for (int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+        {
+            term *= quarterSquare / ((double) k * (double) k);
+            sum += term;
+        }
+
+        return sum;
+    }
+}
+
+//==============================================================================
+LevelMeter::LevelMeter (const SimdKernels::KernelTable& kernelsToUse)
+    : kernels (kernelsToUse)
+{
+    // Kaiser-windowed sinc phases at quarter-sample steps, centred between taps 5 and 6: within
+    // 0.04 dB up to 0.35 of the sample rate, reading low above that
+    constexpr double beta = 5.0;
+    constexpr double halfWidth = 0.5 * tapsPerPhase;
+    const double windowScale = 1.0 / besselI0 (beta);
+
+    for (int phase = 1; phase < oversampling; ++phase)
+    {
+        auto* taps = phaseTaps.data() + (phase - 1) * tapsPerPhase;
+        const double fraction = (double) phase / (double) oversampling;
+        std::array<double, tapsPerPhase> weights {};
+        double sum = 0.0;
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+        {
+            const double distance = halfWidth - 1.0 + fraction - (double) k;
+            const double normalised = distance / halfWidth;
+            const double window = besselI0 (beta * std::sqrt (juce::jmax (0.0, 1.0 - normalised * normalised))) * windowScale;
+            const double x = juce::MathConstants<double>::pi * distance;
+            weights[(size_t) k] = std::sin (x) / x * window;
+            sum += weights[(size_t) k];
+        }
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+            taps[k] = (float) (weights[(size_t) k] / sum);
+    }
+}
+
+void LevelMeter::prepare (double sampleRate)
+{
+    currentSampleRate = sampleRate;
+    holdSamplesLeft = 0;
+
+    for (auto& stage : histories)
+        for (auto& history : stage)
+            history.fill (0.0f);
+
+    running = {};
+    pending = {};
+}
+
+//==============================================================================
+void LevelMeter::accumulate (const float* samples, int numSamples, float* history, SimdKernels::MeterSums& sums) const noexcept
+{
+    constexpr int numPhases = oversampling - 1;
+
+    // The first few outputs need the previous block's tail; past those the block is its own history
+    std::array<float, 2 * historyLength> joined {};
+    const int numJoined = juce::jmin (numSamples, historyLength);
+    std::copy_n (history, historyLength, joined.data());
+    std::copy_n (samples, numJoined, joined.data() + historyLength);
+
+    kernels.meter (joined.data() + historyLength, numJoined, phaseTaps.data(), numPhases, tapsPerPhase, sums);
+
+    if (numSamples > numJoined)
+    {
+        kernels.meter (samples + numJoined, numSamples - numJoined, phaseTaps.data(), numPhases, tapsPerPhase, sums);
+        std::copy_n (samples + numSamples - historyLength, historyLength, history);
+    }
+    else
+    {
+        std::copy_n (joined.data() + numJoined, historyLength, history);
+    }
+}
+
+void LevelMeter::begin (Stage stage, int numChannels) noexcept
+{
+    auto& stageRunning = running[stage == Stage::input ? 0 : 1];
+    stageRunning.sums = {};
+    stageRunning.numChannels = juce::jlimit (0, maxChannels, numChannels);
+    stageRunning.numSamples = 0;
+}
+
+template <typename SampleType>
+void LevelMeter::addChunk (Stage stage, const juce::AudioBuffer<SampleType>& chunk, int startSample) noexcept
+{
+    auto& stageRunning = running[stage == Stage::input ? 0 : 1];
+    auto& stageHistories = histories[stage == Stage::input ? 0 : 1];
+    const int numSamples = chunk.getNumSamples() - startSample;
+    const int numChannels = juce::jmin (stageRunning.numChannels, chunk.getNumChannels());
+
+    if (numSamples <= 0)
+        return;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& sums = stageRunning.sums[(size_t) ch];
+        auto* history = stageHistories[(size_t) ch].data();
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            accumulate (chunk.getReadPointer (ch, startSample), numSamples, history, sums);
+        }
+        else
+        {
+            // The kernel is float only: convert a stack-sized run at a time
+            std::array<float, conversionBlockSize> converted;
+
+            for (int start = 0; start < numSamples; start += conversionBlockSize)
+            {
+                const int count = juce::jmin (conversionBlockSize, numSamples - start);
+                const auto* source = chunk.getReadPointer (ch, startSample + start);
+
+                for (int i = 0; i < count; ++i)
+                    converted[(size_t) i] = (float) source[i];
+
+                accumulate (converted.data(), count, history, sums);
+            }
+        }
+    }
+
+    stageRunning.numSamples += numSamples;
+}
+
+template <typename SampleType>
+LevelMeter::Levels LevelMeter::finishBlock (Stage stage, const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    auto& levels = stage == Stage::input ? pending.input : pending.output;
+    auto& stageRunning = running[stage == Stage::input ? 0 : 1];
+
+    // Whatever nobody fed in as it was written, e.g. audio that never reached the engine
+    if (stageRunning.numSamples < buffer.getNumSamples())
+        addChunk (stage, buffer, stageRunning.numSamples);
+
+    const int numSamples = stageRunning.numSamples;
+    const int numChannels = juce::jmin (stageRunning.numChannels, buffer.getNumChannels());
+    Levels loudest;
+
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        if (ch >= numChannels || numSamples == 0)
+        {
+            levels[(size_t) ch] = {};
+            continue;
+        }
+
+        const auto& sums = stageRunning.sums[(size_t) ch];
+        auto& channel = levels[(size_t) ch];
+        channel.peak = sums.peak;
+        channel.rms = std::sqrt (sums.sumSquares / (float) numSamples);
+        channel.truePeak = juce::jmax (sums.peak, sums.interpolatedPeak);
+
+        loudest.peak = juce::jmax (loudest.peak, channel.peak);
+        loudest.rms = juce::jmax (loudest.rms, channel.rms);
+        loudest.truePeak = juce::jmax (loudest.truePeak, channel.truePeak);
+    }
+
+    return loudest;
+}
+
+LevelMeter::Levels LevelMeter::measure (Stage stage, const juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+{
+    begin (stage, numChannels);
+    return finishBlock (stage, buffer);
+}
+
+LevelMeter::Levels LevelMeter::measure (Stage stage, const juce::AudioBuffer<double>& buffer, int numChannels) noexcept
+{
+    begin (stage, numChannels);
+    return finishBlock (stage, buffer);
+}
+
+void LevelMeter::add (Stage stage, const juce::AudioBuffer<float>& chunk) noexcept
+{
+    addChunk (stage, chunk, 0);
+}
+
+void LevelMeter::add (Stage stage, const juce::AudioBuffer<double>& chunk) noexcept
+{
+    addChunk (stage, chunk, 0);
+}
+
+LevelMeter::Levels LevelMeter::finish (Stage stage, const juce::AudioBuffer<float>& buffer) noexcept
+{
+    return finishBlock (stage, buffer);
+}
+
+LevelMeter::Levels LevelMeter::finish (Stage stage, const juce::AudioBuffer<double>& buffer) noexcept
+{
+    return finishBlock (stage, buffer);
+}
+
+void LevelMeter::publish (int numSamples) noexcept
+{
+    float truePeak = 0.0f;
+
+    for (const auto& channel : pending.output)
+        truePeak = juce::jmax (truePeak, channel.truePeak);
+
+    // Hold the highest peak for peakHoldSeconds, then drop straight to the current one
+    holdSamplesLeft -= numSamples;
+
+    if (truePeak >= pending.truePeakHold || holdSamplesLeft <= 0)
+    {
+        pending.truePeakHold = truePeak;
+        holdSamplesLeft = (juce::int64) (peakHoldSeconds * currentSampleRate);
+    }
+
+    if (clipResetRequested.exchange (false, std::memory_order_relaxed))
+        pending.numClips = 0;
+
+    if (truePeak > 1.0f)
+        ++pending.numClips;
+
+    ++pending.numBlocks;
+
+    std::array<juce::uint64, numWords> raw {};
+    std::memcpy (raw.data(), &pending, sizeof (Snapshot));
+
+    // Single writer: mark the write, store the words, then close it
+    const auto start = sequence.load (std::memory_order_relaxed);
+    sequence.store (start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    for (size_t i = 0; i < numWords; ++i)
+        words[i].store (raw[i], std::memory_order_relaxed);
+
+    sequence.store (start + 2, std::memory_order_release);
+}
+
+LevelMeter::Snapshot LevelMeter::getSnapshot() const noexcept
+{
+    static_assert (std::is_trivially_copyable_v<Snapshot>);
+    std::array<juce::uint64, numWords> raw {};
+
+    // A write takes nanoseconds once a block, so a retry is rare and short
+    for (;;)
+    {
+        const auto before = sequence.load (std::memory_order_acquire);
+
+        if ((before & 1) != 0)
+            continue;
+
+        for (size_t i = 0; i < numWords; ++i)
+            raw[i] = words[i].load (std::memory_order_relaxed);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (sequence.load (std::memory_order_relaxed) == before)
+            break;
+    }
+
+    Snapshot snapshot;
+    std::memcpy (static_cast<void*> (&snapshot), raw.data(), sizeof (Snapshot));
+    return snapshot;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SimdKernels.h"
+#include <array>
+#include <atomic>
+
+/**
+ * Input and output metering for the processor.
+ *
+ * measure() reads each channel once with the SIMD meter kernel, getting peak, RMS and
+ * true peak (4x oversampled, as in ITU-R BS.1770 Annex 2) from the same pass. A stage
+ * written a chunk at a time can instead be fed with add() as each chunk is written,
+ * while it is still in cache, between begin() and finish().
+ * publish() then hands the whole block's levels, the output peak hold and the clip count
+ * to the editor as one Snapshot through a seqlock: the audio thread never waits, and
+ * getSnapshot() retries until it copies a set that was not written under it, so input
+ * and output always come from the same block.
+ */
+class LevelMeter
+{
+public:
+    static constexpr int maxChannels = 2;
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr double peakHoldSeconds = 2.0;
+
+    enum class Stage { input, output };
+
+    struct Levels
+    {
+        float peak = 0.0f;
+        float rms = 0.0f;
+        float truePeak = 0.0f;
+    };
+
+    struct Snapshot
+    {
+        std::array<Levels, maxChannels> input {}, output {};
+        float truePeakHold = 0.0f;      // Highest output true peak over the last peakHoldSeconds
+        juce::uint32 numClips = 0;      // Output blocks whose true peak went over full scale since the last reset
+        juce::uint64 numBlocks = 0;
+    };
+
+    explicit LevelMeter (const SimdKernels::KernelTable& kernelsToUse = SimdKernels::selectKernels());
+
+    // Message thread, with the audio callback stopped
+    void prepare (double sampleRate);
+
+    //==============================================================================
+    // Audio thread
+
+    /** Measures the first numChannels channels of the block for a stage and returns the loudest
+        of each level across them. */
+    Levels measure (Stage stage, const juce::AudioBuffer<float>& buffer, int numChannels) noexcept;
+    Levels measure (Stage stage, const juce::AudioBuffer<double>& buffer, int numChannels) noexcept;
+
+    /** The same in pieces: begin() starts a block, add() takes its next chunk, and finish()
+        measures whatever of the block add() was not given before returning the levels. */
+    void begin (Stage stage, int numChannels) noexcept;
+    void add (Stage stage, const juce::AudioBuffer<float>& chunk) noexcept;
+    void add (Stage stage, const juce::AudioBuffer<double>& chunk) noexcept;
+    Levels finish (Stage stage, const juce::AudioBuffer<float>& buffer) noexcept;
+    Levels finish (Stage stage, const juce::AudioBuffer<double>& buffer) noexcept;
+
+    /** Makes the levels measured since the last call visible to getSnapshot(). */
+    void publish (int numSamples) noexcept;
+
+    //==============================================================================
+    // Any thread
+
+    Snapshot getSnapshot() const noexcept;
+    void resetClips() noexcept { clipResetRequested.store (true, std::memory_order_relaxed); }
+
+private:
+    static constexpr int historyLength = tapsPerPhase - 1;
+    static constexpr int conversionBlockSize = 256;
+
+    // A stage's block so far
+    struct Running
+    {
+        std::array<SimdKernels::MeterSums, maxChannels> sums {};
+        int numChannels = 0;
+        int numSamples = 0;
+    };
+
+    void accumulate (const float* samples, int numSamples, float* history, SimdKernels::MeterSums& sums) const noexcept;
+    template <typename SampleType>
+    void addChunk (Stage stage, const juce::AudioBuffer<SampleType>& chunk, int startSample) noexcept;
+    template <typename SampleType>
+    Levels finishBlock (Stage stage, const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    SimdKernels::KernelTable kernels;
+
+    // Phases 1 to 3 of the interpolator, taps reversed for the kernel; phase 0 is the sample itself
+    std::array<float, (oversampling - 1) * tapsPerPhase> phaseTaps {};
+
+    // Each channel's last historyLength samples per stage, carried into the next block
+    std::array<std::array<std::array<float, historyLength>, maxChannels>, 2> histories {};
+    std::array<Running, 2> running {};
+
+    Snapshot pending;
+    double currentSampleRate = 44100.0;
+    juce::int64 holdSamplesLeft = 0;
+    std::atomic<bool> clipResetRequested { false };
+
+    // The published snapshot as atomic words: an odd sequence means a write is under way
+    static constexpr size_t numWords = (sizeof (Snapshot) + sizeof (juce::uint64) - 1) / sizeof (juce::uint64);
+    std::atomic<juce::uint32> sequence { 0 };
+    std::array<std::atomic<juce::uint64>, numWords> words {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
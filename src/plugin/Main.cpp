@@ -1,6 +1,7 @@
 #include <JuceHeader.h>
 #include <juce_audio_utils/juce_audio_utils.h>
 #include "HostServices.h"
+#include "AudioLogger.h"
 
 using namespace juce;
 
@@ -42,9 +43,8 @@ public:
 	{
 		static int callCount = 0;
 		if (callCount++ < 5)
-			Logger::writeToLog (">>> DiagnosticCallback: audioDeviceIOCallback #" + String(callCount) + 
-			                     " (in:" + String(numInputChannels) + " out:" + String(numOutputChannels) + 
-			                     " samples:" + String(numSamples) + ")");
+			audioLog.post (">>> DiagnosticCallback: audioDeviceIOCallback #{} (in:{} out:{} samples:{})",
+			               { (double) callCount, (double) numInputChannels, (double) numOutputChannels, (double) numSamples });
 		
 		try
 		{
@@ -54,20 +54,21 @@ public:
 				                                                  numSamples, context);
 			
 			if (callCount <= 5)
-				Logger::writeToLog (">>> DiagnosticCallback: callback completed successfully");
+				audioLog.post (">>> DiagnosticCallback: callback completed successfully");
 		}
 		catch (const std::exception& e)
 		{
-			Logger::writeToLog (">>> EXCEPTION in audioDeviceIOCallback: " + String(e.what()));
+			audioLog.post (">>> EXCEPTION in audioDeviceIOCallback", {}, e.what());
 		}
 		catch (...)
 		{
-			Logger::writeToLog (">>> UNKNOWN EXCEPTION in audioDeviceIOCallback");
+			audioLog.post (">>> UNKNOWN EXCEPTION in audioDeviceIOCallback");
 		}
 	}
 	
 private:
 	AudioProcessorPlayer* wrappedPlayer = nullptr;
+	AudioLogger audioLog;	// The device callback must not format or write itself
 };
 
 // Forward declare createPluginFilter() which is defined in PluginProcessor.cpp
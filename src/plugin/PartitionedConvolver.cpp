@@ -0,0 +1,936 @@
+#include "PartitionedConvolver.h"
+#include "SpectralMorph.h"
+
+namespace
+{
+    int getFFTOrder (int blockSize)
+    {
+        return juce::roundToInt (std::log2 (2.0 * blockSize));
+    }
+
+    // Cost of one FFT butterfly relative to one complex multiply-accumulate, used to decide when a
+    // longer block pays for its extra transforms. Measured with juce::dsp::FFT's own engine (what
+    // Windows builds get) against the SSE2 to AVX-512 kernels: 35 to 70, about 9 with the scalar ones.
+    constexpr double fftToMacCostRatio = 48.0;
+
+    // Both sides per output sample. Doubling the block adds one radix-2 level to the forward and
+    // the inverse FFT, about two butterflies, while the remaining partitions' multiply-accumulates
+    // fall from remaining / blockSize to half that.
+    bool isWorthGrowing (int blockSize, int remainingSamples)
+    {
+        const double extraTransformCost = fftToMacCostRatio * 2.0;
+        const double macSaving = (double) remainingSamples / (2.0 * blockSize);
+        return extraTransformCost < macSaving;
+    }
+
+    // Sources and destinations may be double; the conversion happens in the copy
+    template <typename SampleType>
+    void writeToRing (std::vector<float>& ring, int start, const SampleType* source, int numSamples) noexcept
+    {
+        const int first = juce::jmin (numSamples, (int) ring.size() - start);
+        std::copy (source, source + first, ring.data() + start);
+        std::copy (source + first, source + numSamples, ring.data());
+    }
+
+    template <typename SampleType>
+    void readFromRing (const std::vector<float>& ring, int start, SampleType* dest, int numSamples) noexcept
+    {
+        const int first = juce::jmin (numSamples, (int) ring.size() - start);
+        std::copy (ring.data() + start, ring.data() + start + first, dest);
+        std::copy (ring.data(), ring.data() + (numSamples - first), dest + first);
+    }
+
+    void addToRing (std::vector<float>& ring, int start, const float* source, int numSamples) noexcept
+    {
+        const int first = juce::jmin (numSamples, (int) ring.size() - start);
+        juce::FloatVectorOperations::add (ring.data() + start, source, first);
+        juce::FloatVectorOperations::add (ring.data(), source + first, numSamples - first);
+    }
+
+    void clearRing (std::vector<float>& ring, int start, int numSamples) noexcept
+    {
+        const int first = juce::jmin (numSamples, (int) ring.size() - start);
+        std::fill (ring.data() + start, ring.data() + start + first, 0.0f);
+        std::fill (ring.data(), ring.data() + (numSamples - first), 0.0f);
+    }
+
+    bool isSilent (const float* samples, int numSamples) noexcept
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax (samples, numSamples);
+        return range.getStart() > -PartitionedConvolver::silenceThreshold && range.getEnd() < PartitionedConvolver::silenceThreshold;
+    }
+
+    template <typename SampleType>
+    void readAndClearRing (std::vector<float>& ring, int start, SampleType* dest, int numSamples) noexcept
+    {
+        readFromRing (ring, start, dest, numSamples);
+        clearRing (ring, start, numSamples);
+    }
+}
+
+//==============================================================================
+PartitionLayout PartitionLayout::createNonUniform (int irLength, int headBlockSize, int maxBlockSize,
+                                                   int latencySamples, int directHeadLength, int offloadBlockSize)
+{
+    jassert (juce::isPowerOfTwo (headBlockSize) && juce::isPowerOfTwo (maxBlockSize));
+    jassert (directHeadLength + latencySamples >= headBlockSize);
+
+    PartitionLayout result;
+    result.headBlockSize = headBlockSize;
+    result.irLength = irLength;
+    result.directHeadLength = directHeadLength;
+
+    int blockSize = headBlockSize;
+    int offset = directHeadLength;
+
+    while (offset < irLength)
+    {
+        Segment segment { blockSize, offset, 0 };
+
+        while (offset < irLength)
+        {
+            ++segment.numPartitions;
+            offset += blockSize;
+
+            const int nextBlockSize = blockSize * 2;
+
+            const int remaining = irLength - offset;
+            const bool reachesWorkers = nextBlockSize <= offloadBlockSize && remaining >= offloadBlockSize;
+
+            if (nextBlockSize <= maxBlockSize
+                && offset >= 2 * nextBlockSize - latencySamples
+                && (reachesWorkers || isWorthGrowing (blockSize, remaining)))
+                break;
+        }
+
+        result.segments.push_back (segment);
+        blockSize *= 2;
+    }
+
+    return result;
+}
+
+PartitionLayout PartitionLayout::createUniform (int irLength, int blockSize, int numSegments)
+{
+    jassert (juce::isPowerOfTwo (blockSize) && numSegments > 0);
+
+    PartitionLayout result;
+    result.headBlockSize = blockSize;
+    result.irLength = irLength;
+
+    const int totalPartitions = (irLength + blockSize - 1) / blockSize;
+    const int partitionsPerSegment = (totalPartitions + numSegments - 1) / juce::jmax (1, numSegments);
+
+    for (int first = 0; first < totalPartitions; first += partitionsPerSegment)
+        result.segments.push_back ({ blockSize, first * blockSize, juce::jmin (partitionsPerSegment, totalPartitions - first) });
+
+    return result;
+}
+
+int PartitionLayout::getNumPartitions() const noexcept
+{
+    int total = 0;
+    for (const auto& segment : segments)
+        total += segment.numPartitions;
+    return total;
+}
+
+int PartitionLayout::getMaxBlockSize() const noexcept
+{
+    int maxSize = headBlockSize;
+    for (const auto& segment : segments)
+        maxSize = juce::jmax (maxSize, segment.blockSize);
+    return maxSize;
+}
+
+int PartitionLayout::getEndSample() const noexcept
+{
+    if (segments.empty())
+        return 0;
+
+    const auto& last = segments.back();
+    return last.offset + last.numPartitions * last.blockSize;
+}
+
+//==============================================================================
+PartitionedIR::PartitionedIR (const PartitionLayout& layoutToUse, const float* samples, int numSamples, float gain)
+    : layout (layoutToUse)
+{
+    directHeadStorage.assign ((size_t) layout.directHeadLength, 0.0f);
+
+    for (int k = 0; k < juce::jmin (layout.directHeadLength, numSamples); ++k)
+        directHeadStorage[(size_t) (layout.directHeadLength - 1 - k)] = samples[k] * gain;
+
+    computeSegmentStarts();
+    spectraStorage.assign (getSpectraSize (layout), 0.0f);
+
+    for (size_t s = 0; s < layout.segments.size(); ++s)
+    {
+        const auto& segment = layout.segments[s];
+        const int blockSize = segment.blockSize;
+        const int numBins = getNumBins (blockSize);
+
+        juce::dsp::FFT fft (getFFTOrder (blockSize));
+        std::vector<float> buffer ((size_t) blockSize * 4, 0.0f);
+
+        for (int p = 0; p < segment.numPartitions; ++p)
+        {
+            std::fill (buffer.begin(), buffer.end(), 0.0f);
+
+            const int start = segment.offset + p * blockSize;
+            const int count = juce::jlimit (0, blockSize, numSamples - start);
+
+            for (int i = 0; i < count; ++i)
+                buffer[(size_t) i] = samples[start + i] * gain;
+
+            fft.performRealOnlyForwardTransform (buffer.data(), true);
+
+            auto* dest = spectraStorage.data() + segmentStarts[s] + (size_t) p * 2 * (size_t) numBins;
+
+            for (int k = 0; k <= blockSize; ++k)
+            {
+                dest[k] = buffer[(size_t) (2 * k)];
+                dest[numBins + k] = buffer[(size_t) (2 * k + 1)];
+            }
+        }
+    }
+
+    directHeadTaps = directHeadStorage.data();
+    spectra = spectraStorage.data();
+}
+
+PartitionedIR::PartitionedIR (const PartitionLayout& layoutToUse, const float* directHeadTapsToUse,
+                              const float* spectraToUse, std::shared_ptr<const void> storage)
+    : layout (layoutToUse),
+      directHeadTaps (directHeadTapsToUse),
+      spectra (spectraToUse),
+      externalStorage (std::move (storage))
+{
+    computeSegmentStarts();
+}
+
+void PartitionedIR::computeSegmentStarts()
+{
+    size_t totalSize = 0;
+    for (const auto& segment : layout.segments)
+    {
+        segmentStarts.push_back (totalSize);
+        totalSize += (size_t) segment.numPartitions * 2 * (size_t) getNumBins (segment.blockSize);
+    }
+}
+
+size_t PartitionedIR::getSpectraSize (const PartitionLayout& layout) noexcept
+{
+    size_t totalSize = 0;
+    for (const auto& segment : layout.segments)
+        totalSize += (size_t) segment.numPartitions * 2 * (size_t) getNumBins (segment.blockSize);
+    return totalSize;
+}
+
+size_t PartitionedIR::getMemorySize() const noexcept
+{
+    return ((size_t) layout.directHeadLength + getSpectraSize (layout)) * sizeof (float);
+}
+
+int PartitionedIR::getAudibleLength (float thresholdDecibels) const
+{
+    // Energy per block of the IR: the FIR head, then every partition. The spectra are
+    // unscaled transforms of 2 * blockSize points, so Parseval divides by that.
+    std::vector<std::pair<int, double>> blockEnergies;   // End sample, energy
+    double head = 0.0;
+
+    for (int i = 0; i < layout.directHeadLength; ++i)
+        head += (double) directHeadTaps[i] * directHeadTaps[i];
+
+    blockEnergies.push_back ({ layout.directHeadLength, head });
+
+    for (size_t s = 0; s < layout.segments.size(); ++s)
+    {
+        const auto& segment = layout.segments[s];
+        const int numBins = getNumBins (segment.blockSize);
+
+        for (int p = 0; p < segment.numPartitions; ++p)
+        {
+            const auto* re = getPartition ((int) s, p);
+            const auto* im = re + numBins;
+            double energy = 0.0;
+
+            for (int k = 0; k <= segment.blockSize; ++k)
+                energy += (k == 0 || k == segment.blockSize ? 1.0 : 2.0) * ((double) re[k] * re[k] + (double) im[k] * im[k]);
+
+            blockEnergies.push_back ({ segment.offset + (p + 1) * segment.blockSize, energy / (2.0 * segment.blockSize) });
+        }
+    }
+
+    double total = 0.0;
+    for (const auto& block : blockEnergies)
+        total += block.second;
+
+    // Walk back from the end until the energy behind us is audible
+    const double limit = total * std::pow (10.0, thresholdDecibels / 10.0);
+    double remaining = 0.0;
+
+    for (auto block = blockEnergies.rbegin(); block != blockEnergies.rend(); ++block)
+    {
+        remaining += block->second;
+
+        if (remaining > limit)
+            return juce::jmin (block->first, layout.irLength);
+    }
+
+    return 0;
+}
+
+const float* PartitionedIR::getPartition (int segment, int partition) const noexcept
+{
+    const int numBins = getNumBins (layout.segments[(size_t) segment].blockSize);
+    return spectra + segmentStarts[(size_t) segment] + (size_t) partition * 2 * (size_t) numBins;
+}
+
+int PartitionedIR::getNumBins (int blockSize) noexcept
+{
+    constexpr int binAlignment = 16;
+    return ((blockSize + 1 + binAlignment - 1) / binAlignment) * binAlignment;
+}
+
+//==============================================================================
+struct PartitionedConvolver::SegmentTask : public ConvolutionWorkerPool::Task
+{
+    SegmentTask (PartitionedConvolver& ownerToUse, int segment)
+        : owner (ownerToUse), segmentIndex (segment)
+    {
+    }
+
+    void run() noexcept override
+    {
+        owner.convolveSegment (segmentIndex);
+    }
+
+    PartitionedConvolver& owner;
+    const int segmentIndex;
+};
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver (const SimdKernels::KernelTable& kernelsToUse)
+    : kernels (kernelsToUse)
+{
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    releaseTasks();
+}
+
+void PartitionedConvolver::setScheduling (Scheduling schedulingToUse, ConvolutionWorkerPool* pool, int minBlockSize) noexcept
+{
+    jassert (segments.empty());
+    jassert ((schedulingToUse != Scheduling::workerThreads && schedulingToUse != Scheduling::offlineWorkers) || pool != nullptr);
+
+    scheduling = schedulingToUse;
+    workerPool = pool;
+    minScheduledBlockSize = minBlockSize;
+}
+
+void PartitionedConvolver::releaseTasks()
+{
+    for (auto& state : segments)
+    {
+        if (state.taskSlot >= 0)
+            workerPool->removeTask (state.taskSlot);
+
+        state.taskSlot = -1;
+        state.task.reset();
+    }
+}
+
+void PartitionedConvolver::prepare (const PartitionLayout& layoutToUse, int numInputs, int numOutputs, int latencySamples)
+{
+    releaseTasks();
+
+    layout = layoutToUse;
+    latency = latencySamples;
+    numOffloadedSegments = 0;
+    paths.clear();
+    morphs.clear();
+    gains.clear();
+
+    // A worker segment may start its block up to a block late, so its input window has to last that long
+    const bool usesWorkers = scheduling == Scheduling::workerThreads || scheduling == Scheduling::offlineWorkers;
+    const int historySize = juce::nextPowerOfTwo (juce::jmax ((usesWorkers ? 3 : 2) * layout.getMaxBlockSize(),
+                                                              layout.directHeadLength + layout.headBlockSize));
+    const int outputSize = juce::nextPowerOfTwo (layout.getEndSample() + layout.headBlockSize + latency + 1);
+    historyMask = historySize - 1;
+    outputMask = outputSize - 1;
+
+    inputs.clear();
+    inputs.resize ((size_t) numInputs);
+
+    for (auto& input : inputs)
+    {
+        input.history.assign ((size_t) historySize, 0.0f);
+        input.directHeadInput.assign ((size_t) (layout.directHeadLength + layout.headBlockSize), 0.0f);
+    }
+
+    outputRings.assign ((size_t) numOutputs, std::vector<float> ((size_t) outputSize, 0.0f));
+    directHeadOutput.assign ((size_t) layout.headBlockSize, 0.0f);
+
+    segments.clear();
+    segments.resize (layout.segments.size());
+
+    for (size_t s = 0; s < layout.segments.size(); ++s)
+    {
+        const auto& segment = layout.segments[s];
+        const auto spectrumSize = (size_t) (2 * PartitionedIR::getNumBins (segment.blockSize));
+        auto& state = segments[s];
+
+        // Each segment gets its own FFT so workers never contend on a shared one
+        state.fft = std::make_unique<juce::dsp::FFT> (getFFTOrder (segment.blockSize));
+        state.delayLines.assign (spectrumSize * (size_t) segment.numPartitions * (size_t) numInputs, 0.0f);
+        state.accumulators.clear();
+        state.blockGains.clear();
+        state.fftBuffers.assign ((size_t) segment.blockSize * 4 * (size_t) juce::jmax (numInputs, numOutputs), 0.0f);
+        state.liveSlots.assign ((size_t) segment.numPartitions * (size_t) numInputs, 0);
+        state.numLiveSlots = 0;
+        state.blockIsLive = false;
+        state.delayLineHead = 0;
+        state.taskPosition = -1;
+        state.pendingPosition = -1;
+        state.numSkippedBlocks = 0;
+        state.resultDropped = false;
+        state.numSteps = 0;
+        state.nextStep = 0;
+
+        // Reschedule only if the result is not needed until the segment's next block boundary
+        const int slack = segment.offset + latency - segment.blockSize;
+
+        if (scheduling == Scheduling::audioThread || segment.blockSize < minScheduledBlockSize || slack < segment.blockSize)
+            continue;
+
+        if (usesWorkers)
+        {
+            state.task = std::make_unique<SegmentTask> (*this, (int) s);
+            state.taskSlot = workerPool->addTask (state.task.get());
+
+            if (state.taskSlot < 0)
+            {
+                state.task.reset();
+                continue;
+            }
+        }
+        else
+        {
+            // Stagger the transforms so segments that fall due together
+            // do not all run their FFTs on the same tick
+            state.numSteps = segment.blockSize / layout.headBlockSize;
+            const int stagger = (int) s % juce::jmax (1, state.numSteps / 4);
+            state.nextStep = state.numSteps;
+            state.forwardStep = stagger;
+            state.inverseStep = state.numSteps - 1 - stagger;
+        }
+
+        ++numOffloadedSegments;
+    }
+
+    tailLength = 0;
+    tickFill = 0;
+    samplePosition = 0;
+}
+
+void PartitionedConvolver::addPath (int input, int output, std::shared_ptr<const PartitionedIR> ir, int gainGroup)
+{
+    jassert (ir != nullptr && ir->getLayout().segments.size() == layout.segments.size());
+
+    if (ir == nullptr || ! juce::isPositiveAndBelow (input, (int) inputs.size())
+                      || ! juce::isPositiveAndBelow (output, (int) outputRings.size()) || gainGroup < 0)
+        return;
+
+    tailLength = juce::jmax (tailLength, ir->getAudibleLength (tailThresholdDecibels));
+    paths.push_back ({ input, output, gainGroup, std::move (ir) });
+
+    // New groups start at unity gain
+    while ((int) gains.size() <= gainGroup)
+    {
+        gains.emplace_back (1.0f);
+        gains.back().reset (juce::jmax (1, gainRampLength));
+    }
+
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+        const auto spectrumSize = (size_t) (2 * PartitionedIR::getNumBins (layout.segments[s].blockSize));
+        segments[s].accumulators.assign (spectrumSize * outputRings.size() * gains.size(), 0.0f);
+        segments[s].blockGains.assign (gains.size(), 1.0f);
+    }
+}
+
+void PartitionedConvolver::addPath (int input, int output, std::shared_ptr<SpectralMorph> morph, int gainGroup)
+{
+    jassert (morph != nullptr);
+
+    if (morph == nullptr)
+        return;
+
+    // The path's IR is the morph's output and keeps the morph alive
+    const auto numPaths = paths.size();
+    const auto* morphOutput = &morph->getOutput();
+    addPath (input, output, std::shared_ptr<const PartitionedIR> (morph, morphOutput), gainGroup);
+
+    if (paths.size() == numPaths)
+        return;
+
+    // The morph can move to any of its sources, so its whole length may ring
+    tailLength = juce::jmax (tailLength, layout.irLength);
+
+    if (std::find (morphs.begin(), morphs.end(), morph.get()) == morphs.end())
+        morphs.push_back (morph.get());
+}
+
+void PartitionedConvolver::setMorphPosition (float position) noexcept
+{
+    for (auto* morph : morphs)
+        morph->setPosition (position);
+}
+
+void PartitionedConvolver::setGainRampLength (int numSamples) noexcept
+{
+    gainRampLength = juce::jmax (0, numSamples);
+
+    for (auto& gain : gains)
+    {
+        const auto target = gain.getTargetValue();
+        gain.reset (juce::jmax (1, gainRampLength));
+        gain.setCurrentAndTargetValue (target);
+    }
+}
+
+void PartitionedConvolver::setGain (int gainGroup, float gain, bool ramp) noexcept
+{
+    if (! juce::isPositiveAndBelow (gainGroup, (int) gains.size()))
+        return;
+
+    if (ramp && gainRampLength > 0)
+        gains[(size_t) gainGroup].setTargetValue (gain);
+    else
+        gains[(size_t) gainGroup].setCurrentAndTargetValue (gain);
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    for (auto& input : inputs)
+        std::fill (input.history.begin(), input.history.end(), 0.0f);
+
+    for (auto& ring : outputRings)
+        std::fill (ring.begin(), ring.end(), 0.0f);
+
+    for (auto& state : segments)
+    {
+        // Wait for any in-flight task before clearing the state it works on
+        if (state.taskSlot >= 0)
+            workerPool->waitForTask (state.taskSlot);
+
+        std::fill (state.delayLines.begin(), state.delayLines.end(), 0.0f);
+        std::fill (state.liveSlots.begin(), state.liveSlots.end(), 0);
+        state.numLiveSlots = 0;
+        state.blockIsLive = false;
+        state.delayLineHead = 0;
+        state.taskPosition = -1;
+        state.pendingPosition = -1;
+        state.numSkippedBlocks = 0;
+        state.resultDropped = false;
+        state.nextStep = state.numSteps;
+    }
+
+    tickFill = 0;
+    samplePosition = 0;
+}
+
+template <typename SampleType>
+void PartitionedConvolver::process (const SampleType* const* input, int numInputChannels,
+                                    SampleType* const* output, int numOutputChannels, int numSamples) noexcept
+{
+    numOutputChannels = juce::jmin (numOutputChannels, (int) outputRings.size());
+
+    if (numInputChannels <= 0 || inputs.empty() || layout.headBlockSize <= 0)
+        return;
+
+    const int numTaps = layout.directHeadLength;
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        const int numThisTime = juce::jmin (numSamples - done, layout.headBlockSize - tickFill);
+        const int historyStart = (int) (samplePosition & historyMask);
+        const int outputStart = (int) (samplePosition & outputMask);
+
+        // Every input is stored before any output is written, since they may share memory
+        for (size_t in = 0; in < inputs.size(); ++in)
+        {
+            auto& state = inputs[in];
+            writeToRing (state.history, historyStart, input[juce::jmin ((int) in, numInputChannels - 1)] + done, numThisTime);
+
+            // The newest numThisTime inputs are in the history now, plus the taps - 1 before them
+            if (numTaps > 0)
+            {
+                readFromRing (state.history, (int) ((samplePosition - (numTaps - 1)) & historyMask),
+                              state.directHeadInput.data(), numTaps - 1 + numThisTime);
+                state.directHeadIsLive = ! isSilent (state.directHeadInput.data(), numTaps - 1 + numThisTime);
+            }
+        }
+
+        for (int out = 0; out < (int) outputRings.size(); ++out)
+        {
+            if (out < numOutputChannels)
+                readAndClearRing (outputRings[(size_t) out], outputStart, output[out] + done, numThisTime);
+            else
+                clearRing (outputRings[(size_t) out], outputStart, numThisTime);
+        }
+
+        if (numTaps > 0)
+        {
+            for (const auto& path : paths)
+            {
+                if (path.output >= numOutputChannels || ! inputs[(size_t) path.input].directHeadIsLive)
+                    continue;
+
+                // The head is heard immediately, so its gain ramps per sample
+                const auto& gain = gains[(size_t) path.gainGroup];
+                auto* dest = output[path.output] + done;
+
+                if constexpr (std::is_same_v<SampleType, float>)
+                {
+                    if (! gain.isSmoothing() && gain.getCurrentValue() == 1.0f)
+                    {
+                        kernels.fir (path.ir->getDirectHeadTaps(), numTaps, inputs[(size_t) path.input].directHeadInput.data(),
+                                     dest, numThisTime);
+                        continue;
+                    }
+                }
+
+                std::fill (directHeadOutput.begin(), directHeadOutput.begin() + numThisTime, 0.0f);
+                kernels.fir (path.ir->getDirectHeadTaps(), numTaps, inputs[(size_t) path.input].directHeadInput.data(),
+                             directHeadOutput.data(), numThisTime);
+
+                auto ramp = gain;
+                for (int i = 0; i < numThisTime; ++i)
+                    dest[i] += (SampleType) (directHeadOutput[(size_t) i] * ramp.getNextValue());
+            }
+        }
+
+        for (auto& gain : gains)
+            gain.skip (numThisTime);
+
+        samplePosition += numThisTime;
+        tickFill += numThisTime;
+        done += numThisTime;
+
+        if (tickFill == layout.headBlockSize)
+        {
+            tickFill = 0;
+            processTick();
+        }
+    }
+}
+
+template void PartitionedConvolver::process (const float* const*, int, float* const*, int, int) noexcept;
+template void PartitionedConvolver::process (const double* const*, int, double* const*, int, int) noexcept;
+
+void PartitionedConvolver::processTick() noexcept
+{
+    // The FIR head runs on this thread, so its taps can follow the morph straight away
+    for (auto* morph : morphs)
+        morph->updateDirectHead();
+
+    for (size_t s = 0; s < layout.segments.size(); ++s)
+    {
+        const auto blockSize = (juce::int64) layout.segments[s].blockSize;
+
+        if (segments[s].taskSlot >= 0)
+            serviceWorkerSegment ((int) s);
+        else if ((samplePosition & (blockSize - 1)) == 0)
+            processSegment ((int) s);
+        else if (segments[s].nextStep < segments[s].numSteps)
+            runSegmentStep ((int) s);
+    }
+}
+
+void PartitionedConvolver::processSegment (int segmentIndex) noexcept
+{
+    if (paths.empty())
+        return;
+
+    auto& state = segments[(size_t) segmentIndex];
+
+    // The previous block's result is due from this boundary on, and its state has to be free again
+    collectSegment (segmentIndex);
+    startBlock (segmentIndex, samplePosition);
+
+    if (state.numSteps > 0)
+    {
+        state.nextStep = 0;
+        runSegmentStep (segmentIndex);
+        return;
+    }
+
+    convolveSegment (segmentIndex);
+    collectSegment (segmentIndex);
+}
+
+void PartitionedConvolver::serviceWorkerSegment (int segmentIndex) noexcept
+{
+    if (paths.empty())
+        return;
+
+    const auto& segment = layout.segments[(size_t) segmentIndex];
+    auto& state = segments[(size_t) segmentIndex];
+
+    // A new boundary queues its block; one still waiting from the last boundary has lost its turn.
+    // Offline, nothing loses its turn: the running task is waited for and collected first.
+    if ((samplePosition & (segment.blockSize - 1)) == 0)
+    {
+        if (scheduling == Scheduling::offlineWorkers && state.taskPosition >= 0)
+        {
+            workerPool->waitForTask (state.taskSlot);
+            collectSegment (segmentIndex);
+        }
+
+        if (state.pendingPosition >= 0)
+            ++state.numSkippedBlocks;
+
+        state.pendingPosition = samplePosition;
+    }
+
+    if (state.taskPosition >= 0)
+    {
+        // This is the last tick before the output ring reaches the result
+        const auto outputStart = state.taskPosition - segment.blockSize + segment.offset + latency;
+        const bool resultIsDue = samplePosition + layout.headBlockSize > outputStart;
+
+        if (resultIsDue && scheduling == Scheduling::offlineWorkers)
+            workerPool->waitForTask (state.taskSlot);
+        else if (! workerPool->collect (state.taskSlot, resultIsDue && ! state.resultDropped))
+        {
+            state.resultDropped = state.resultDropped || resultIsDue;
+            return;
+        }
+
+        if (state.resultDropped)
+            state.taskPosition = -1;
+        else
+            collectSegment (segmentIndex);
+
+        state.resultDropped = false;
+    }
+
+    if (state.pendingPosition < 0)
+        return;
+
+    // Skipped blocks still move the delay line on, as silence
+    for (; state.numSkippedBlocks > 0; --state.numSkippedBlocks)
+    {
+        state.delayLineHead = (state.delayLineHead + segment.numPartitions - 1) % segment.numPartitions;
+
+        for (size_t in = 0; in < inputs.size(); ++in)
+        {
+            auto& live = state.liveSlots[in * (size_t) segment.numPartitions + (size_t) state.delayLineHead];
+            state.numLiveSlots -= (int) live;
+            live = 0;
+        }
+    }
+
+    startBlock (segmentIndex, std::exchange (state.pendingPosition, -1));
+    workerPool->submit (state.taskSlot);
+}
+
+void PartitionedConvolver::startBlock (int segmentIndex, juce::int64 position) noexcept
+{
+    const int blockSize = layout.segments[(size_t) segmentIndex].blockSize;
+    auto& state = segments[(size_t) segmentIndex];
+
+    for (size_t g = 0; g < gains.size(); ++g)
+        state.blockGains[g] = gains[g].getCurrentValue();
+
+    // Overlap-save: transform the last two blocks of every input
+    for (size_t in = 0; in < inputs.size(); ++in)
+        readFromRing (inputs[in].history, (int) ((position - 2 * blockSize) & historyMask),
+                      state.fftBuffers.data() + in * (size_t) (4 * blockSize), 2 * blockSize);
+
+    state.taskPosition = position;
+}
+
+void PartitionedConvolver::runSegmentStep (int segmentIndex) noexcept
+{
+    auto& state = segments[(size_t) segmentIndex];
+    const int step = state.nextStep++;
+
+    if (paths.empty() || state.taskPosition < 0)
+        return;
+
+    // Forward FFTs, then the partitions in even slices, then the inverse FFTs
+    const int numPartitions = layout.segments[(size_t) segmentIndex].numPartitions;
+    const int numMacSteps = state.inverseStep - state.forwardStep - 1;
+
+    if (step == state.forwardStep)
+    {
+        forwardTransform (segmentIndex);
+
+        if (numMacSteps <= 0)
+            multiplyAccumulate (segmentIndex, 0, numPartitions);
+    }
+    else if (step > state.forwardStep && step < state.inverseStep)
+    {
+        const int slice = step - state.forwardStep - 1;
+        multiplyAccumulate (segmentIndex,
+                            numPartitions * slice / numMacSteps,
+                            numPartitions * (slice + 1) / numMacSteps);
+    }
+
+    if (step == state.inverseStep)
+        inverseTransform (segmentIndex);
+}
+
+void PartitionedConvolver::collectSegment (int segmentIndex) noexcept
+{
+    auto& state = segments[(size_t) segmentIndex];
+
+    if (state.taskPosition < 0)
+        return;
+
+    // Every step has normally run by now, but finish any that have not
+    while (state.nextStep < state.numSteps)
+        runSegmentStep (segmentIndex);
+
+    // The second half of the circular result is the valid linear convolution
+    const auto& segment = layout.segments[(size_t) segmentIndex];
+    const auto outputStart = state.taskPosition - segment.blockSize + segment.offset + latency;
+
+    for (size_t out = 0; state.blockIsLive && out < outputRings.size(); ++out)
+        addToRing (outputRings[out], (int) (outputStart & outputMask),
+                   state.fftBuffers.data() + out * (size_t) (4 * segment.blockSize) + segment.blockSize, segment.blockSize);
+
+    state.taskPosition = -1;
+}
+
+void PartitionedConvolver::convolveSegment (int segmentIndex) noexcept
+{
+    // Touches only this segment's state, so it can run on a worker thread
+    forwardTransform (segmentIndex);
+    multiplyAccumulate (segmentIndex, 0, layout.segments[(size_t) segmentIndex].numPartitions);
+    inverseTransform (segmentIndex);
+}
+
+void PartitionedConvolver::forwardTransform (int segmentIndex) noexcept
+{
+    const auto& segment = layout.segments[(size_t) segmentIndex];
+    auto& state = segments[(size_t) segmentIndex];
+
+    const int blockSize = segment.blockSize;
+    const int numBins = PartitionedIR::getNumBins (blockSize);
+    const auto spectrumSize = (size_t) (2 * numBins);
+
+    state.delayLineHead = (state.delayLineHead + segment.numPartitions - 1) % segment.numPartitions;
+
+    // One transform per input, shared by every path that reads it. Silent windows are not
+    // transformed; their slot is marked so the multiply-accumulates skip it instead.
+    for (size_t in = 0; in < inputs.size(); ++in)
+    {
+        auto* buffer = state.fftBuffers.data() + in * (size_t) (4 * blockSize);
+        auto& live = state.liveSlots[in * (size_t) segment.numPartitions + (size_t) state.delayLineHead];
+        const bool wasLive = live != 0;
+        live = isSilent (buffer, 2 * blockSize) ? 0 : 1;
+        state.numLiveSlots += (int) live - (int) wasLive;
+
+        if (! live)
+            continue;
+
+        state.fft->performRealOnlyForwardTransform (buffer, true);
+
+        auto* newest = state.delayLines.data() + (in * (size_t) segment.numPartitions + (size_t) state.delayLineHead) * spectrumSize;
+
+        for (int k = 0; k <= blockSize; ++k)
+        {
+            newest[k] = buffer[2 * k];
+            newest[numBins + k] = buffer[2 * k + 1];
+        }
+    }
+
+    // With every slot silent there is nothing to accumulate and no result to add
+    state.blockIsLive = state.numLiveSlots > 0;
+
+    if (state.blockIsLive)
+        std::fill (state.accumulators.begin(), state.accumulators.end(), 0.0f);
+
+    // Morphed partitions are only read by this segment, so it rewrites them itself before they are used
+    for (auto* morph : morphs)
+        morph->updateSegment (segmentIndex);
+}
+
+void PartitionedConvolver::multiplyAccumulate (int segmentIndex, int firstPartition, int endPartition) noexcept
+{
+    // Multiply-accumulate each path's input delay line against its IR partitions
+    const auto& segment = layout.segments[(size_t) segmentIndex];
+    auto& state = segments[(size_t) segmentIndex];
+
+    const int numBins = PartitionedIR::getNumBins (segment.blockSize);
+    const auto spectrumSize = (size_t) (2 * numBins);
+
+    if (! state.blockIsLive)
+        return;
+
+    for (const auto& path : paths)
+    {
+        const auto* delayLine = state.delayLines.data() + (size_t) path.input * (size_t) segment.numPartitions * spectrumSize;
+        const auto* liveSlots = state.liveSlots.data() + (size_t) path.input * (size_t) segment.numPartitions;
+        auto* accumulator = state.accumulators.data()
+                          + ((size_t) path.gainGroup * outputRings.size() + (size_t) path.output) * spectrumSize;
+
+        for (int p = firstPartition; p < endPartition; ++p)
+        {
+            const int slot = (state.delayLineHead + p) % segment.numPartitions;
+
+            if (! liveSlots[slot])
+                continue;
+
+            kernels.complexMac (delayLine + (size_t) slot * spectrumSize,
+                                path.ir->getPartition (segmentIndex, p),
+                                accumulator, numBins);
+        }
+    }
+}
+
+void PartitionedConvolver::inverseTransform (int segmentIndex) noexcept
+{
+    auto& state = segments[(size_t) segmentIndex];
+
+    const int blockSize = layout.segments[(size_t) segmentIndex].blockSize;
+    const int numBins = PartitionedIR::getNumBins (blockSize);
+    const auto spectrumSize = (size_t) (2 * numBins);
+    const auto groupStride = outputRings.size() * spectrumSize;
+
+    if (! state.blockIsLive)
+        return;
+
+    for (size_t out = 0; out < outputRings.size(); ++out)
+    {
+        // Scale the groups and sum them into the first group's accumulator
+        auto* acc = state.accumulators.data() + out * spectrumSize;
+
+        if (state.blockGains.size() > 1 || state.blockGains[0] != 1.0f)
+        {
+            juce::FloatVectorOperations::multiply (acc, state.blockGains[0], (int) spectrumSize);
+
+            for (size_t g = 1; g < state.blockGains.size(); ++g)
+                juce::FloatVectorOperations::addWithMultiply (acc, acc + g * groupStride, state.blockGains[g], (int) spectrumSize);
+        }
+
+        const auto* accRe = acc;
+        const auto* accIm = accRe + numBins;
+        auto* buffer = state.fftBuffers.data() + out * (size_t) (4 * blockSize);
+
+        for (int k = 0; k <= blockSize; ++k)
+        {
+            buffer[2 * k] = accRe[k];
+            buffer[2 * k + 1] = accIm[k];
+        }
+
+        state.fft->performRealOnlyInverseTransform (buffer);
+    }
+}
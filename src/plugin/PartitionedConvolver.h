@@ -0,0 +1,285 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+#include "SimdKernels.h"
+#include "ConvolutionWorkerPool.h"
+
+class SpectralMorph;
+
+/**
+ * Describes how an impulse response is split into frequency-domain partitions.
+ *
+ * Short blocks sit at the head of the IR (low latency) and the block size
+ * doubles towards the tail (fewer FFTs per sample). Each segment is a
+ * uniformly partitioned convolution over its own slice of the IR.
+ */
+struct PartitionLayout
+{
+    struct Segment
+    {
+        int blockSize = 0;      // FFT size is 2 * blockSize
+        int offset = 0;         // First IR sample covered by this segment
+        int numPartitions = 0;
+    };
+
+    std::vector<Segment> segments;
+    int headBlockSize = 0;
+    int irLength = 0;
+    int directHeadLength = 0;   // Leading taps run as a time-domain FIR instead of FFT partitions
+
+    /** Builds a layout that starts at headBlockSize and doubles up to maxBlockSize.
+        A segment only grows once its offset leaves a full block period of slack
+        between the input becoming available and the output being due, and once the
+        rest of the IR is long enough for the larger block's fewer multiply-accumulates
+        to pay for its longer transforms. Blocks of at least offloadBlockSize (if not 0)
+        will run on worker threads, so the layout grows towards that size whenever the
+        rest of the IR still fills such a block, whatever the cost on one thread.
+        With directHeadLength > 0 the partitions start after the FIR head, which
+        lets the layout run with zero latency when directHeadLength >= headBlockSize. */
+    static PartitionLayout createNonUniform (int irLength, int headBlockSize, int maxBlockSize,
+                                             int latencySamples, int directHeadLength = 0,
+                                             int offloadBlockSize = 0);
+
+    /** Builds a layout of blockSize partitions only, split into numSegments runs of
+        (nearly) equal length. With a latency of one block every run after the first has
+        a block of slack, so each can be handed to its own worker thread. */
+    static PartitionLayout createUniform (int irLength, int blockSize, int numSegments = 1);
+
+    int getNumPartitions() const noexcept;
+    int getMaxBlockSize() const noexcept;
+    int getEndSample() const noexcept;
+};
+
+/**
+ * Frequency-domain partitions of one IR channel, prepared for a layout.
+ * Immutable once built, so several convolvers can share one instance.
+ */
+class PartitionedIR
+{
+public:
+    PartitionedIR (const PartitionLayout& layout, const float* samples, int numSamples, float gain = 1.0f);
+
+    /** Wraps partitions prepared earlier, e.g. mapped from the on-disk cache. Nothing is
+        copied: storage must keep directHeadTaps and spectra alive and unchanged. */
+    PartitionedIR (const PartitionLayout& layout, const float* directHeadTaps, const float* spectra,
+                   std::shared_ptr<const void> storage);
+
+    const PartitionLayout& getLayout() const noexcept { return layout; }
+
+    // Split-complex spectrum of a partition (numBins real values followed by numBins imaginary values)
+    const float* getPartition (int segment, int partition) const noexcept;
+
+    // Number of bins stored per spectrum, padded so SIMD loops need no remainder
+    static int getNumBins (int blockSize) noexcept;
+
+    // Time-reversed FIR head (layout.directHeadLength taps)
+    const float* getDirectHeadTaps() const noexcept { return directHeadTaps; }
+
+    // All partition spectra back to back (getSpectraSize (layout) floats)
+    const float* getSpectra() const noexcept { return spectra; }
+    static size_t getSpectraSize (const PartitionLayout& layout) noexcept;
+
+    size_t getMemorySize() const noexcept;
+
+    /** Samples from the start of the IR until the energy still to come falls below
+        thresholdDecibels of the total, to partition resolution. Reads every partition. */
+    int getAudibleLength (float thresholdDecibels) const;
+
+private:
+    void computeSegmentStarts();
+
+    PartitionLayout layout;
+    std::vector<float> directHeadStorage;
+    std::vector<float> spectraStorage;
+    const float* directHeadTaps = nullptr;
+    const float* spectra = nullptr;
+    std::shared_ptr<const void> externalStorage;
+    std::vector<size_t> segmentStarts;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedIR)
+};
+
+/**
+ * Non-uniform partitioned convolution.
+ *
+ * Any number of inputs is routed to any number of outputs through paths, each
+ * with its own IR: one path per channel for plain stereo, one input feeding
+ * two outputs for mono-to-stereo, or four paths for true stereo. Every input
+ * is transformed once per block and its spectra are shared by all paths that
+ * read it, so extra paths only add multiply-accumulates.
+ *
+ * Paths belong to gain groups, which lets several IRs be blended: each group
+ * accumulates separately and is scaled by its own smoothed gain before the
+ * single inverse transform per output. A path can also read a SpectralMorph,
+ * whose partitions each segment moves towards the morph position as it goes.
+ *
+ * Processes any number of samples per call. Input is collected into
+ * headBlockSize ticks; on each tick every segment whose block boundary
+ * falls due transforms its input windows, multiply-accumulates them against
+ * their frequency-domain delay lines and adds the result into the output rings.
+ * An optional direct-form FIR covers the first taps sample by sample.
+ *
+ * Silence costs almost nothing: a window of input below silenceThreshold is
+ * not transformed, and its delay line slot is skipped by every multiply-
+ * accumulate, so once the tail has rung out no FFTs run until signal returns.
+ *
+ * Segments whose output is due at least one full block after their input
+ * arrives do not have to finish on the tick they start. They can be split
+ * into steps that run on the following ticks and are collected at their next
+ * block boundary, or handed to background threads. A worker's result is
+ * picked up on the first tick it is ready, as late as the tick its output is
+ * due; until then the segment's next block waits its turn. The audio thread
+ * never waits for a worker: a result still being computed when it is due is
+ * dropped, and a block that could not be started before the one after it
+ * arrived is left out of the delay line.
+ */
+class PartitionedConvolver
+{
+public:
+    enum class Scheduling
+    {
+        audioThread,        // Every segment runs in full on the tick it falls due
+        workerThreads,      // Late segments run on a ConvolutionWorkerPool; the audio thread never waits for them
+        timeDistributed,    // Late segments are split into steps spread over the ticks before they are due
+        offlineWorkers      // As workerThreads, but the caller waits for late results rather than drop or skip blocks
+    };
+
+    explicit PartitionedConvolver (const SimdKernels::KernelTable& kernelsToUse);
+    ~PartitionedConvolver();
+
+    // Call before prepare(). Only segments of at least minBlockSize with a block of slack are rescheduled.
+    void setScheduling (Scheduling scheduling, ConvolutionWorkerPool* pool, int minBlockSize) noexcept;
+
+    // Allocates all working memory and removes all paths - call off the audio thread
+    void prepare (const PartitionLayout& layout, int numInputs, int numOutputs, int latencySamples);
+
+    // Filters an input into an output. Several paths may share an input or an output.
+    void addPath (int input, int output, std::shared_ptr<const PartitionedIR> ir, int gainGroup = 0);
+    void addPath (int input, int output, std::shared_ptr<SpectralMorph> morph, int gainGroup = 0);
+    void reset() noexcept;
+
+    // Gain changes ramp over this many samples (audio thread, or before processing starts)
+    void setGainRampLength (int numSamples) noexcept;
+
+    // Real-time safe. Segments pick up the gain as they start a block, the FIR head per sample.
+    void setGain (int gainGroup, float gain, bool ramp = true) noexcept;
+    int getNumGainGroups() const noexcept { return (int) gains.size(); }
+
+    // Real-time safe; moves every morph the paths read (0 to 1)
+    void setMorphPosition (float position) noexcept;
+    int getNumMorphs() const noexcept { return (int) morphs.size(); }
+
+    /** Real-time safe; inputs and outputs may point to the same memory.
+        Missing inputs reuse the last one given, missing outputs are dropped.
+        Runs for float and double; spectra are always float, and double samples
+        are converted as they enter and leave the rings. */
+    template <typename SampleType>
+    void process (const SampleType* const* input, int numInputChannels,
+                  SampleType* const* output, int numOutputChannels, int numSamples) noexcept;
+
+    template <typename SampleType>
+    void process (const SampleType* const* input, SampleType* const* output, int numChannels, int numSamples) noexcept
+    {
+        process (input, numChannels, output, numChannels, numSamples);
+    }
+
+    // Input whose magnitude stays below this (-120 dBFS) is treated as silence
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    // The tail has rung out once the IR energy still to come is this far below its total
+    static constexpr float tailThresholdDecibels = -100.0f;
+
+    // Samples from the last non-silent input until the output has rung out, latency included
+    int getTailLength() const noexcept { return latency + tailLength; }
+
+    int getLatencySamples() const noexcept { return latency; }
+    const PartitionLayout& getLayout() const noexcept { return layout; }
+    int getNumInputs() const noexcept { return (int) inputs.size(); }
+    int getNumOutputs() const noexcept { return (int) outputRings.size(); }
+    int getNumPaths() const noexcept { return (int) paths.size(); }
+    int getNumOffloadedSegments() const noexcept { return numOffloadedSegments; }
+
+private:
+    struct SegmentTask;
+
+    struct SegmentState
+    {
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> delayLines;      // numPartitions spectra per input, newest at delayLineHead
+        std::vector<float> accumulators;    // One spectrum per gain group and output
+        std::vector<float> blockGains;      // Group gains taken when the block started
+        std::vector<float> fftBuffers;      // One per input or output, whichever there are more of
+        std::vector<char> liveSlots;        // Per input and delay line slot: false while the slot holds silence
+        int numLiveSlots = 0;
+        bool blockIsLive = false;           // The current block has anything to multiply, so a result to add
+        int delayLineHead = 0;
+
+        // Background processing: the task owns this state between submit and collect
+        std::unique_ptr<SegmentTask> task;
+        int taskSlot = -1;
+        juce::int64 taskPosition = -1;
+        juce::int64 pendingPosition = -1;   // A block boundary whose work waits for the task to come back
+        int numSkippedBlocks = 0;           // Boundaries that never got their turn, so their slots stay silent
+        bool resultDropped = false;         // The running task's result came too late to be added
+
+        // Time-distributed processing: numSteps ticks per block, 0 when not distributed
+        int numSteps = 0;
+        int nextStep = 0;
+        int forwardStep = 0;
+        int inverseStep = 0;
+    };
+
+    struct InputState
+    {
+        std::vector<float> history;
+        std::vector<float> directHeadInput;  // Contiguous copy of the input the FIR head needs
+        bool directHeadIsLive = false;
+    };
+
+    struct Path
+    {
+        int input = 0;
+        int output = 0;
+        int gainGroup = 0;
+        std::shared_ptr<const PartitionedIR> ir;
+    };
+
+    void processTick() noexcept;
+    void processSegment (int segmentIndex) noexcept;
+    void serviceWorkerSegment (int segmentIndex) noexcept;
+    void startBlock (int segmentIndex, juce::int64 position) noexcept;
+    void convolveSegment (int segmentIndex) noexcept;
+    void collectSegment (int segmentIndex) noexcept;
+    void runSegmentStep (int segmentIndex) noexcept;
+    void forwardTransform (int segmentIndex) noexcept;
+    void multiplyAccumulate (int segmentIndex, int firstPartition, int endPartition) noexcept;
+    void inverseTransform (int segmentIndex) noexcept;
+    void releaseTasks();
+
+    SimdKernels::KernelTable kernels;
+    PartitionLayout layout;
+    std::vector<InputState> inputs;
+    std::vector<std::vector<float>> outputRings;
+    std::vector<SegmentState> segments;
+    std::vector<Path> paths;
+    std::vector<SpectralMorph*> morphs;     // Kept alive by the paths' IRs
+    std::vector<juce::SmoothedValue<float>> gains;
+    std::vector<float> directHeadOutput;
+    int gainRampLength = 0;
+    int tailLength = 0;
+
+    Scheduling scheduling = Scheduling::audioThread;
+    ConvolutionWorkerPool* workerPool = nullptr;
+    int minScheduledBlockSize = 0;
+    int numOffloadedSegments = 0;
+
+    int latency = 0;
+    int historyMask = 0;
+    int outputMask = 0;
+    int tickFill = 0;
+    juce::int64 samplePosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
@@ -113,7 +113,22 @@ void PluginEditor::createUIComponents()
         irSelector->addItem (irs[i].name, i + 1);
     }
     
-    if (irs.size() > 0)
+    // Second IR of a blend; the blend gains are the processor's "Blend Gain" parameters
+    blendSelector = std::make_unique<juce::ComboBox> ("BlendSelector");
+    blendSelector->setTooltip ("Blend the selected IR with a second one, blend the three can sizes, or morph between them");
+    refreshBlendList();
+    blendSelector->addListener (this);
+    addAndMakeVisible (*blendSelector);
+
+    if (selectBlendSources())
+    {
+        DBG("  Restored blend or morph: " + blendSelector->getText());
+    }
+    else if (! processor.getMorphFiles().isEmpty())
+    {
+        DBG("  Restored morph of " + juce::String (processor.getMorphFiles().size()) + " IRs");
+    }
+    else if (irs.size() > 0)
     {
         irSelector->setSelectedItemIndex (0, juce::dontSendNotification);
         DBG("  Selected first IR: " + irs[0].name);
@@ -164,6 +179,29 @@ void PluginEditor::createUIComponents()
     addAndMakeVisible (*resampleIrButton);
     resampleIrButton->setButtonText(processor.isIrResampleEnabled() ? "IR Resample: ON" : "IR Resample: OFF");
     DBG("  IR resample toggle added");
+
+    // Auto-trim floor; changing it reloads the selected IR
+    autoTrimSelector = std::make_unique<juce::ComboBox> ("AutoTrim");
+    autoTrimSelector->setTooltip ("Cut the IR where its decay falls below this level");
+
+    for (int i = 0; i < (int) std::size (autoTrimFloors); ++i)
+        autoTrimSelector->addItem (autoTrimFloors[i] < 0.0f ? "Trim: " + juce::String (autoTrimFloors[i], 0) + " dB" : "Trim: OFF", i + 1);
+
+    for (int i = 0; i < (int) std::size (autoTrimFloors); ++i)
+        if (autoTrimFloors[i] == processor.getAutoTrimFloor())
+            autoTrimSelector->setSelectedItemIndex (i, juce::dontSendNotification);
+
+    autoTrimSelector->addListener (this);
+    addAndMakeVisible (*autoTrimSelector);
+    DBG("  Auto-trim selector added");
+
+    // Minimum-phase conversion; toggling it reloads the selected IR
+    minimumPhaseButton = std::make_unique<juce::ToggleButton> ("Min Phase: OFF");
+    minimumPhaseButton->addListener (this);
+    minimumPhaseButton->setToggleState (processor.isMinimumPhaseEnabled(), juce::NotificationType::dontSendNotification);
+    minimumPhaseButton->setButtonText (processor.isMinimumPhaseEnabled() ? "Min Phase: ON" : "Min Phase: OFF");
+    addAndMakeVisible (*minimumPhaseButton);
+    DBG("  Minimum phase toggle added");
     
     // Audio Settings button - opens JUCE's AudioDeviceSelectorComponent
     audioSettingsButton = std::make_unique<juce::TextButton> ("Audio Settings");
@@ -247,8 +285,12 @@ void PluginEditor::rebuildLayout()
         testToneButton->setButtonText("Tone");
         y += buttonH + buttonGap;
 
-        // IR resample toggle
-        resampleIrButton->setBounds(xMargin, y, w - xMargin * 2, buttonH);
+        // IR resample toggle and auto-trim floor
+        resampleIrButton->setBounds(xMargin, y, halfWidth, buttonH);
+        autoTrimSelector->setBounds(xMargin + halfWidth + buttonGap, y, halfWidth, buttonH);
+        y += buttonH + buttonGap;
+        minimumPhaseButton->setBounds(xMargin, y, halfWidth, buttonH);
+        blendSelector->setBounds(xMargin + halfWidth + buttonGap, y, halfWidth, buttonH);
     }
     else
     {
@@ -300,6 +342,10 @@ void PluginEditor::rebuildLayout()
             resampleIrButton->setBounds(xMargin + (buttonW + buttonGap) * 3, y, buttonW, buttonH);
             testToneButton->setButtonText("Test Tone: OFF");
             audioSettingsButton->setBounds(xMargin + (buttonW + buttonGap) * 4, y, buttonW, buttonH);
+            y += buttonH + buttonGap;
+            blendSelector->setBounds(xMargin, y, buttonW * 2 + buttonGap, buttonH);
+            minimumPhaseButton->setBounds(xMargin + (buttonW + buttonGap) * 2, y, buttonW, buttonH);
+            autoTrimSelector->setBounds(xMargin + (buttonW + buttonGap) * 3, y, buttonW, buttonH);
         }
         else
         {
@@ -311,6 +357,11 @@ void PluginEditor::rebuildLayout()
             y += buttonH + buttonGap;
             resampleIrButton->setBounds(xMargin, y, availableWidth / 2 - buttonGap/2, buttonH);
             audioSettingsButton->setBounds(xMargin + availableWidth / 2 + buttonGap/2, y, availableWidth / 2 - buttonGap/2, buttonH);
+            y += buttonH + buttonGap;
+            autoTrimSelector->setBounds(xMargin, y, availableWidth / 2 - buttonGap/2, buttonH);
+            minimumPhaseButton->setBounds(xMargin + availableWidth / 2 + buttonGap/2, y, availableWidth / 2 - buttonGap/2, buttonH);
+            y += buttonH + buttonGap;
+            blendSelector->setBounds(xMargin, y, availableWidth, buttonH);
         }
     }
 }
@@ -388,7 +439,7 @@ void PluginEditor::paint (juce::Graphics& g)
     auto meterHeight = 20;
     auto meterGap = 8;
 
-    auto drawMeter = [&g] (juce::Rectangle<int> bounds, const juce::String& label, float value)
+    auto drawMeter = [&g] (juce::Rectangle<int> bounds, const juce::String& label, float value, float hold)
     {
         auto labelArea = bounds.removeFromLeft (80);
         g.setColour (juce::Colours::white);
@@ -405,13 +456,33 @@ void PluginEditor::paint (juce::Graphics& g)
 
         g.setColour (clamped > 0.9f ? juce::Colours::red : (clamped > 0.6f ? juce::Colours::orange : juce::Colours::green));
         g.fillRect (fill);
+
+        // Peak hold marker
+        if (hold > 0.0f)
+        {
+            auto holdX = meterBounds.getX() + juce::roundToInt ((meterBounds.getWidth() - 1) * juce::jlimit (0.0f, 1.0f, hold));
+            g.setColour (hold > 0.9f ? juce::Colours::red : juce::Colours::white);
+            g.fillRect (holdX, meterBounds.getY(), 2, meterBounds.getHeight());
+        }
+
         g.setColour (juce::Colours::grey);
         g.drawRect (meterBounds);
     };
 
     // Draw only the convolution (2nd) meter
     auto meterRect = juce::Rectangle<int> (meterArea.getX(), meterArea.getY(), meterArea.getWidth(), meterHeight);
-    drawMeter (meterRect, "Conv Output", convolutionMeter);
+    drawMeter (meterRect, "Conv Output", convolutionMeter, peakHoldMeter);
+    convolutionMeterBounds = meterRect;
+
+    // Held true peak and clip count underneath, the count in red once anything clipped
+    auto readoutRect = meterRect.translated (80, meterHeight + meterGap).withWidth (meterRect.getWidth() - 80);
+    auto holdText = "Peak hold: " + (truePeakHold > 0.0f ? juce::String (juce::Decibels::gainToDecibels (truePeakHold), 1) + " dBTP" : juce::String ("-inf"));
+    g.setColour (juce::Colours::white);
+    g.setFont (12.0f);
+    g.drawText (holdText, readoutRect, juce::Justification::centredLeft);
+    g.setColour (numClips > 0 ? juce::Colours::red : juce::Colours::white);
+    g.drawText ("Clips: " + juce::String (numClips) + (numClips > 0 ? " (click meter to reset)" : ""),
+                readoutRect, juce::Justification::centredRight);
 }
 
 void PluginEditor::resized()
@@ -432,13 +503,35 @@ void PluginEditor::timerCallback()
         return juce::jlimit (0.0f, 1.0f, (db + 60.0f) / 60.0f);
     };
 
-    inputMeter = toMeter (processor.getInputLevel());
-    convolutionMeter = toMeter (processor.getConvolutionLevel());
-    outputMeter = toMeter (processor.getOutputLevel());
+    // One snapshot, so input and output come from the same block
+    const auto meters = processor.getMeterSnapshot();
+    float inputRms = 0.0f, outputRms = 0.0f, outputTruePeak = 0.0f;
+
+    for (size_t ch = 0; ch < meters.input.size(); ++ch)
+    {
+        inputRms = juce::jmax (inputRms, meters.input[ch].rms);
+        outputRms = juce::jmax (outputRms, meters.output[ch].rms);
+        outputTruePeak = juce::jmax (outputTruePeak, meters.output[ch].truePeak);
+    }
+
+    inputMeter = toMeter (inputRms);
+    convolutionMeter = toMeter (outputRms);
+    outputMeter = toMeter (outputTruePeak);
+    peakHoldMeter = toMeter (meters.truePeakHold);
+    truePeakHold = meters.truePeakHold;
+    numClips = meters.numClips;
     
+    // Show progress while an IR is loading in the background
+    if (pendingIRLoad != nullptr && irStatusLabel)
+    {
+        irStatusLabel->setText ("IR Status: Loading " + pendingIRLoad->getFile().getFileName() + "... "
+                                + juce::String (juce::roundToInt (pendingIRLoad->getProgress() * 100.0f)) + "%",
+                                juce::NotificationType::dontSendNotification);
+    }
+
     // Only update IR status if it changed
     static bool lastIRLoaded = false;
-    if (irStatusLabel && processor.isIrLoaded() != lastIRLoaded)
+    if (pendingIRLoad == nullptr && irStatusLabel && processor.isIrLoaded() != lastIRLoaded)
     {
         lastIRLoaded = processor.isIrLoaded();
         irStatusLabel->setText (lastIRLoaded ? "IR Status: Loaded" : "IR Status: Not loaded",
@@ -462,7 +555,19 @@ void PluginEditor::timerCallback()
         if (sr > 0.0)
         {
             auto text = "Sample Rate: " + juce::String (sr, 0) + " Hz  |  Block: " + juce::String (bs)
+                       + "  |  Latency: " + juce::String (processor.getLatencySamples())
                        + "  |  Callbacks: " + juce::String (static_cast<long long> (callbacks));
+
+            const auto workerStats = processor.getConvolutionWorkerStats();
+            if (workerStats.tasksSubmitted > 0)
+                text += "  |  Tail jobs: " + juce::String (workerStats.tasksSubmitted)
+                      + " (missed " + juce::String (workerStats.deadlineMisses)
+                      + ", dropped " + juce::String (workerStats.resultsDropped) + ")";
+
+            const auto blockCost = processor.getConvolutionBlockCost();
+            if (blockCost.numBlocks > 0)
+                text += "  |  Conv: " + juce::String (blockCost.averageMs, 3) + " ms avg, "
+                      + juce::String (blockCost.worstMs, 3) + " ms worst";
             sampleRateLabel->setText (text, juce::NotificationType::dontSendNotification);
 
             if (audioStatusLabel)
@@ -486,6 +591,16 @@ void PluginEditor::timerCallback()
     repaint();
 }
 
+void PluginEditor::mouseDown (const juce::MouseEvent& event)
+{
+    if (convolutionMeterBounds.contains (event.getPosition()))
+    {
+        processor.resetMeterClips();
+        numClips = 0;
+        repaint();
+    }
+}
+
 void PluginEditor::buttonClicked(juce::Button* button)
 {
     if (button == reloadIRButton.get())
@@ -505,7 +620,7 @@ void PluginEditor::buttonClicked(juce::Button* button)
             if (file.existsAsFile())
             {
                 DBG("  Loading IR: " + file.getFullPathName());
-                processor.loadImpulseResponse (file);
+                startIRLoad (file);
                 processor.getIRLibrary().addCustomIR (file);
                 
                 // Add to dropdown
@@ -516,9 +631,8 @@ void PluginEditor::buttonClicked(juce::Button* button)
                 {
                     irSelector->addItem (irs[i].name, i + 1);
                 }
-                irSelector->setSelectedItemIndex (irs.size() - 1);
-                
-                irStatusLabel->setText("IR: Loaded " + file.getFileName(), juce::NotificationType::dontSendNotification);
+                irSelector->setSelectedItemIndex (irs.size() - 1, juce::dontSendNotification);
+                refreshBlendList();
             }
             else
             {
@@ -543,7 +657,7 @@ void PluginEditor::buttonClicked(juce::Button* button)
             if (file.existsAsFile())
             {
                 DBG("  Loading custom IR: " + file.getFullPathName());
-                processor.loadImpulseResponse (file);
+                startIRLoad (file);
                 processor.getIRLibrary().addCustomIR (file);
                 
                 // Add to dropdown
@@ -554,9 +668,8 @@ void PluginEditor::buttonClicked(juce::Button* button)
                 {
                     irSelector->addItem (irs[i].name, i + 1);
                 }
-                irSelector->setSelectedItemIndex (irs.size() - 1);
-                
-                irStatusLabel->setText("IR: Loaded " + file.getFileName(), juce::NotificationType::dontSendNotification);
+                irSelector->setSelectedItemIndex (irs.size() - 1, juce::dontSendNotification);
+                refreshBlendList();
             }
             else
             {
@@ -598,6 +711,14 @@ void PluginEditor::buttonClicked(juce::Button* button)
         processor.setIrResampleEnabled(isEnabled);
         resampleIrButton->setButtonText(isEnabled ? "IR Resample: ON" : "IR Resample: OFF");
     }
+    else if (button == minimumPhaseButton.get())
+    {
+        bool isEnabled = minimumPhaseButton->getToggleState();
+        DBG("=== MINIMUM PHASE TOGGLED: " << (isEnabled ? "ON" : "OFF") << " ===");
+        processor.setMinimumPhaseEnabled(isEnabled);
+        minimumPhaseButton->setButtonText(isEnabled ? "Min Phase: ON" : "Min Phase: OFF");
+        comboBoxChanged (irSelector.get());
+    }
 }
 
 void PluginEditor::comboBoxChanged (juce::ComboBox* comboBoxThatHasChanged)
@@ -614,39 +735,122 @@ void PluginEditor::comboBoxChanged (juce::ComboBox* comboBoxThatHasChanged)
         DBG("=== CAN SIZE CHANGED: " + juce::String(canSizes[selectedIndex].name) + " ===");
         updateCanSize(selectedIndex);
     }
-    else if (comboBoxThatHasChanged == irSelector.get())
+    else if (comboBoxThatHasChanged == autoTrimSelector.get())
     {
-        int selectedIndex = irSelector->getSelectedItemIndex();
-        DBG("=== IR SELECTOR CHANGED: index " << selectedIndex << " ===");
-        
+        const int selectedIndex = autoTrimSelector->getSelectedItemIndex();
+        DBG("=== AUTO-TRIM CHANGED: " + autoTrimSelector->getText() + " ===");
+
         if (selectedIndex >= 0)
         {
-            auto& lib = processor.getIRLibrary();
-            const auto& irs = lib.getAvailableIRs();
-            
-            if (selectedIndex < irs.size())
-            {
-                const auto& selectedIR = irs[selectedIndex];
-                DBG("  Selected IR: " + selectedIR.name);
-                DBG("  Loading from: " + selectedIR.file.getFullPathName());
-                DBG("  File exists: " << (selectedIR.file.existsAsFile() ? "true" : "false"));
-                
-                processor.loadImpulseResponse (selectedIR.file);
-                
-                // Check actual state after loading
-                bool irLoaded = processor.isIrLoaded();
-                DBG("  After load - isIrLoaded(): " << (irLoaded ? "true" : "false"));
-                
-                irStatusLabel->setText(irLoaded ? "IR Status: Loaded" : "IR Status: Load Failed",
-                                        juce::NotificationType::dontSendNotification);
-                DBG("  Status label updated");
-            }
-            else
-            {
-                DBG("  ERROR: selectedIndex " << selectedIndex << " >= irs.size() " << irs.size());
-            }
+            processor.setAutoTrimFloor (autoTrimFloors[selectedIndex]);
+            comboBoxChanged (irSelector.get());
         }
     }
+    else if (comboBoxThatHasChanged == irSelector.get())
+    {
+        DBG("=== IR SELECTOR CHANGED: index " << irSelector->getSelectedItemIndex() << " ===");
+        loadSelectedIR();
+    }
+    else if (comboBoxThatHasChanged == blendSelector.get())
+    {
+        DBG("=== BLEND CHANGED: " + blendSelector->getText() + " ===");
+        loadSelectedIR();
+    }
+}
+
+void PluginEditor::loadSelectedIR()
+{
+    const auto& irs = processor.getIRLibrary().getAvailableIRs();
+    const int selectedIndex = irSelector->getSelectedItemIndex();
+    const int blendId = blendSelector->getSelectedId();
+
+    if (blendId == blendCanSizesId)
+    {
+        startBlendLoad (processor.getPresetProfileFiles());
+        return;
+    }
+
+    if (blendId == morphCanSizesId)
+    {
+        startCanSizeMorphLoad();
+        return;
+    }
+
+    if (! juce::isPositiveAndBelow (selectedIndex, irs.size()))
+    {
+        DBG("  ERROR: selectedIndex " << selectedIndex << " outside the " << irs.size() << " IRs");
+        return;
+    }
+
+    const auto& selectedIR = irs.getReference (selectedIndex);
+    const int secondIndex = blendId - firstBlendIRId;
+    DBG("  Selected IR: " + selectedIR.name);
+    DBG("  Loading from: " + selectedIR.file.getFullPathName());
+    DBG("  File exists: " << (selectedIR.file.existsAsFile() ? "true" : "false"));
+
+    if (juce::isPositiveAndBelow (secondIndex, irs.size()))
+        startBlendLoad ({ selectedIR.file, irs.getReference (secondIndex).file });
+    else
+        startIRLoad (selectedIR.file);
+}
+
+void PluginEditor::refreshBlendList()
+{
+    const int selectedId = blendSelector->getSelectedId();
+    const auto& irs = processor.getIRLibrary().getAvailableIRs();
+
+    blendSelector->clear (juce::dontSendNotification);
+    blendSelector->addItem ("Blend: OFF", blendOffId);
+    blendSelector->addItem ("Blend: Small + Regular + Grande", blendCanSizesId);
+    blendSelector->addItem ("Morph: Small / Regular / Grande", morphCanSizesId);
+
+    for (int i = 0; i < irs.size(); ++i)
+        blendSelector->addItem ("Blend with: " + irs[i].name, firstBlendIRId + i);
+
+    blendSelector->setSelectedId (selectedId > 0 && blendSelector->indexOfItemId (selectedId) >= 0 ? selectedId : blendOffId,
+                                  juce::dontSendNotification);
+}
+
+bool PluginEditor::selectBlendSources()
+{
+    // The can size morph is shown on the same selector
+    if (const auto morphFiles = processor.getMorphFiles(); ! morphFiles.isEmpty() && morphFiles == processor.getPresetProfileFiles())
+    {
+        blendSelector->setSelectedId (morphCanSizesId, juce::dontSendNotification);
+        return true;
+    }
+
+    const auto files = processor.getBlendFiles();
+
+    if (files.isEmpty())
+        return false;
+
+    if (files == processor.getPresetProfileFiles())
+    {
+        blendSelector->setSelectedId (blendCanSizesId, juce::dontSendNotification);
+        return true;
+    }
+
+    // Otherwise it is the selected IR and a second one, both from the library
+    const auto& irs = processor.getIRLibrary().getAvailableIRs();
+    auto findIR = [&irs] (const juce::File& file)
+    {
+        for (int i = 0; i < irs.size(); ++i)
+            if (irs.getReference (i).file == file)
+                return i;
+
+        return -1;
+    };
+
+    const int first = findIR (files.getFirst());
+    const int second = files.size() == 2 ? findIR (files.getLast()) : -1;
+
+    if (first < 0 || second < 0)
+        return false;
+
+    irSelector->setSelectedItemIndex (first, juce::dontSendNotification);
+    blendSelector->setSelectedId (firstBlendIRId + second, juce::dontSendNotification);
+    return true;
 }
 
 void PluginEditor::refreshIRList()
@@ -666,16 +870,118 @@ void PluginEditor::refreshIRList()
         DBG("  Adding: " + irs[i].name);
         irSelector->addItem (irs[i].name, i + 1);
     }
-    
-    if (irs.size() > 0)
+
+    refreshBlendList();
+
+    // A blend or morph restored with the session is already loading
+    if (selectBlendSources() || ! processor.getMorphFiles().isEmpty())
+    {
+        DBG("  Kept the restored blend or morph");
+    }
+    else if (irs.size() > 0)
     {
         irSelector->setSelectedItemIndex (0, juce::dontSendNotification);
         DBG("  Selected first IR");
-        processor.loadImpulseResponse (irs[0].file);
+        startIRLoad (irs[0].file);
+    }
+}
+
+void PluginEditor::startIRLoad (const juce::File& file)
+{
+    if (irStatusLabel)
+        irStatusLabel->setText ("IR Status: Loading " + file.getFileName() + "...", juce::NotificationType::dontSendNotification);
+
+    // A single IR replaces any blend
+    if (blendSelector)
+        blendSelector->setSelectedId (blendOffId, juce::dontSendNotification);
+
+    pendingIRLoad = processor.loadImpulseResponseAsync (file, makeLoadCallback());
+}
+
+void PluginEditor::startBlendLoad (const juce::Array<juce::File>& files)
+{
+    pendingIRLoad = processor.loadBlend (files, makeLoadCallback());
+
+    if (pendingIRLoad == nullptr)
+    {
+        blendSelector->setSelectedId (blendOffId, juce::dontSendNotification);
+
         if (irStatusLabel)
-            irStatusLabel->setText (processor.isIrLoaded() ? "IR Status: Loaded" : "IR Status: Not loaded",
-                                    juce::NotificationType::dontSendNotification);
+            irStatusLabel->setText ("IR Status: Blend IRs not found", juce::NotificationType::dontSendNotification);
+
+        return;
     }
+
+    if (irStatusLabel)
+        irStatusLabel->setText ("IR Status: Loading blend of " + juce::String (files.size()) + " IRs...",
+                                juce::NotificationType::dontSendNotification);
+}
+
+void PluginEditor::startCanSizeMorphLoad()
+{
+    pendingIRLoad = processor.loadPresetMorph (makeLoadCallback());
+
+    if (irStatusLabel)
+        irStatusLabel->setText (pendingIRLoad != nullptr ? "IR Status: Loading can size morph..." : "IR Status: Can size profiles not found",
+                                juce::NotificationType::dontSendNotification);
+
+    if (pendingIRLoad == nullptr)
+    {
+        blendSelector->setSelectedId (blendOffId, juce::dontSendNotification);
+        return;
+    }
+
+    // The morph starts at the selected can size
+    auto& morph = processor.getCanSizeMorphParameter();
+    morph.beginChangeGesture();
+    morph.setValueNotifyingHost ((float) currentCanSize / 2.0f);
+    morph.endChangeGesture();
+}
+
+ConvolutionEngine::LoadCallback PluginEditor::makeLoadCallback()
+{
+    // The editor may be closed before the load finishes
+    juce::Component::SafePointer<PluginEditor> safeThis (this);
+
+    return [safeThis] (const IRLoadHandle& handle)
+    {
+        if (safeThis == nullptr || safeThis->pendingIRLoad.get() != &handle)
+            return;
+
+        safeThis->pendingIRLoad.reset();
+
+        juce::String text;
+        switch (handle.getState())
+        {
+            case IRLoadHandle::State::finished:  text = "IR Status: Loaded " + handle.getFile().getFileName(); break;
+            case IRLoadHandle::State::cancelled: text = "IR Status: Load cancelled"; break;
+            default:                             text = "IR Status: Load Failed (" + handle.getErrorMessage() + ")"; break;
+        }
+
+        if (handle.getState() == IRLoadHandle::State::finished && handle.getSources() == IRLoadHandle::Sources::blend)
+            text += " + " + juce::String (handle.getFiles().size() - 1) + " more (blend)";
+        else if (handle.getState() == IRLoadHandle::State::finished && handle.getSources() == IRLoadHandle::Sources::morph)
+            text += " + " + juce::String (handle.getFiles().size() - 1) + " more (can size morph)";
+
+        // Report what auto-trim took off
+        const auto trim = safeThis->processor.getTrimReport();
+        if (handle.getState() == IRLoadHandle::State::finished && trim.secondsSaved > 0.0)
+        {
+            text += " (trimmed " + juce::String (trim.secondsSaved, 1) + " s, "
+                  + juce::String (trim.partitionsSaved) + " partitions saved";
+
+            if (trim.transformPartitionsSaved != 0 || trim.transformMs > 0.0)
+                text += "; min phase " + juce::String (trim.transformPartitionsSaved) + " of them, "
+                      + juce::String (trim.transformMs, 0) + " ms";
+
+            text += ")";
+        }
+
+        DBG("  Async IR load done: " + text);
+
+        if (safeThis->irStatusLabel)
+            safeThis->irStatusLabel->setText (text, juce::NotificationType::dontSendNotification);
+    };
 }
 void PluginEditor::updateCanFlavor(int flavorIndex)
 {
@@ -732,6 +1038,15 @@ void PluginEditor::updateCanSize(int sizeIndex)
         // For subsequent Small/Large selections, just update layout without resizing
         resized();
     }
+
+    // With the profiles loaded as a morph, the can size also moves the IR there (Small, Regular, Grande)
+    if (processor.isMorphLoaded())
+    {
+        auto& morph = processor.getCanSizeMorphParameter();
+        morph.beginChangeGesture();
+        morph.setValueNotifyingHost ((float) sizeIndex / 2.0f);
+        morph.endChangeGesture();
+    }
 }
 
 juce::Colour PluginEditor::getCurrentFlavorColor() const
@@ -17,12 +17,21 @@ public:
     void paint (juce::Graphics& g) override;
     void resized() override;
     void timerCallback() override;
+    void mouseDown (const juce::MouseEvent& event) override;
     
     void buttonClicked(juce::Button* button) override;
     void comboBoxChanged (juce::ComboBox* comboBoxThatHasChanged) override;
     
     // Refresh IR list in dropdown (call after prepareToPlay)
     void refreshIRList();
+
+    // Loads in the background; progress is shown in the IR status label
+    void startIRLoad (const juce::File& file);
+    void startBlendLoad (const juce::Array<juce::File>& files);
+    void startCanSizeMorphLoad();
+
+    // Loads the selected IR, blended with whatever the blend selector names
+    void loadSelectedIR();
     
     // Can flavor/size management
     void updateCanFlavor(int flavorIndex);
@@ -50,12 +59,30 @@ private:
     std::unique_ptr<juce::ToggleButton> bypassButton;
     std::unique_ptr<juce::ToggleButton> testToneButton;
     std::unique_ptr<juce::ToggleButton> resampleIrButton;
+    std::unique_ptr<juce::ComboBox> autoTrimSelector;
+    std::unique_ptr<juce::ToggleButton> minimumPhaseButton;
+    std::unique_ptr<juce::ComboBox> blendSelector;
     std::unique_ptr<juce::TextButton> audioSettingsButton;
     std::unique_ptr<juce::FileChooser> irFileChooser;
+    std::shared_ptr<IRLoadHandle> pendingIRLoad;
+
+    ConvolutionEngine::LoadCallback makeLoadCallback();
+    void refreshBlendList();
+    bool selectBlendSources();   // Shows the processor's blend or can size morph in the selectors; false if it has neither
+
+    // Blend selector items: off, the three can size profiles as a blend or a morph, then each library IR as the second source
+    static constexpr int blendOffId = 1;
+    static constexpr int blendCanSizesId = 2;
+    static constexpr int morphCanSizesId = 3;
+    static constexpr int firstBlendIRId = 4;
 
     float inputMeter = 0.0f;
     float convolutionMeter = 0.0f;
     float outputMeter = 0.0f;
+    float peakHoldMeter = 0.0f;
+    float truePeakHold = 0.0f;                      // Linear, held by the processor's meter
+    juce::uint32 numClips = 0;
+    juce::Rectangle<int> convolutionMeterBounds;    // Clicking it resets the clip count
     
     // Can selection state
     int currentCanFlavor = 0;
@@ -80,6 +107,9 @@ private:
         const char* name;
         uint32_t rgbColor; // 0xRRGGBB format
     };
+    // Auto-trim floors offered in the selector; 0 is off
+    static constexpr float autoTrimFloors[] = { 0.0f, -40.0f, -50.0f, -60.0f, -70.0f, -80.0f };
+
     static constexpr FlavorInfo flavors[10] = {
         {"Original", 0xCC0000},                 // Bright Red
         {"Sour Cream & Onion", 0x9ACD32},       // Lime Green
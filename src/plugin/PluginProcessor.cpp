@@ -11,11 +11,32 @@ PluginProcessor::PluginProcessor()
     DBG("=== PluginProcessor CONSTRUCTOR START ===");
     convolutionEngine = std::make_unique<ConvolutionEngine>();
     convolutionEngine->setIrResampleEnabled(true);
+    convolutionEngine->setOutputMeter (&levelMeter);
+
+    // 0 = Small, 0.5 = Regular, 1 = Grande once loadPresetMorph has run (the editor's can size selector does)
+    addParameter (canSizeMorph = new juce::AudioParameterFloat (juce::ParameterID { "canSizeMorph", 1 },
+                                                                "Can Size Morph", 0.0f, 1.0f, 0.5f));
+    addParameter (mix = new juce::AudioParameterFloat (juce::ParameterID { "mix", 1 }, "Mix", 0.0f, 1.0f, 1.0f));
+
+    // Gains of the blend sources; the engine ramps them, so automation does not click
+    static_assert (numBlendGains <= ConvolutionEngine::maxBlendSources);
+    for (int source = 0; source < numBlendGains; ++source)
+        addParameter (blendGains[(size_t) source] = new juce::AudioParameterFloat (juce::ParameterID { "blendGain" + juce::String (source + 1), 1 },
+                                                                                  "Blend Gain " + juce::String (source + 1),
+                                                                                  0.0f, 1.0f, 1.0f));
+
+    // The standalone build is used for tracking, where monitoring latency matters more than CPU
+    processingMode = juce::JUCEApplicationBase::isStandaloneApp() ? ConvolutionEngine::Algorithm::zeroLatency
+                                                                   : ConvolutionEngine::Algorithm::nonUniformPartitioned;
+
+    // The engine changes its latency when a rebuilt convolver is swapped in on the audio thread
+    startTimerHz (latencyPollHz);
     DBG("=== PluginProcessor CONSTRUCTOR END - ConvolutionEngine created ===");
 }
 
 PluginProcessor::~PluginProcessor()
 {
+    stopTimer();
 }
 
 void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
@@ -23,12 +44,16 @@ void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     juce::Logger::writeToLog (">>> PluginProcessor::prepareToPlay START (SR:" + juce::String(sampleRate) + " BS:" + juce::String(samplesPerBlock) + ")");
 
     prepareToPlayCount.fetch_add (1, std::memory_order_relaxed);
+    reprepareRequested.store (false);   // This applies the restored settings anyway
 
     currentSampleRateHz.store (sampleRate);
     currentBlockSize.store (samplesPerBlock);
+    levelMeter.prepare (sampleRate);
     
-    convolutionEngine->prepareToPlay (sampleRate, samplesPerBlock);
-    juce::Logger::writeToLog (">>> PluginProcessor::prepareToPlay - ConvolutionEngine prepared");
+    convolutionEngine->prepareToPlay (sampleRate, samplesPerBlock, getEngineAlgorithm(), getTotalNumInputChannels());
+    setLatencySamples (convolutionEngine->getLatencySamples());
+    juce::Logger::writeToLog (">>> PluginProcessor::prepareToPlay - ConvolutionEngine prepared (latency "
+                              + juce::String (convolutionEngine->getLatencySamples()) + " samples)");
     
     // Don't load IR here - it causes blocking file I/O on audio thread
     // IR will be loaded later from the message thread
@@ -37,6 +62,59 @@ void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     juce::Logger::writeToLog (">>> PluginProcessor::prepareToPlay END - IR Loaded: " + juce::String(irLoaded ? "true" : "false"));
 }
 
+ConvolutionEngine::Algorithm PluginProcessor::getEngineAlgorithm() const noexcept
+{
+    // Hosts switch to non-realtime and re-prepare before a bounce, where only throughput matters
+    return isNonRealtime() ? ConvolutionEngine::Algorithm::offline : processingMode.load();
+}
+
+void PluginProcessor::setProcessingMode (ConvolutionEngine::Algorithm mode)
+{
+    if (processingMode.exchange (mode) != mode)
+        reprepareEngine();
+}
+
+void PluginProcessor::setInternalBlockSize (int numSamples)
+{
+    if (convolutionEngine == nullptr || convolutionEngine->getInternalBlockSize() == juce::jmax (1, numSamples))
+        return;
+
+    convolutionEngine->setInternalBlockSize (numSamples);
+    reprepareEngine();
+}
+
+void PluginProcessor::reprepareEngine()
+{
+    // Before the first prepareToPlay there is nothing to redo; the settings apply then
+    if (convolutionEngine == nullptr || currentSampleRateHz.load() <= 0.0)
+        return;
+
+    suspendProcessing (true);
+    convolutionEngine->prepareToPlay (currentSampleRateHz.load(), currentBlockSize.load(),
+                                      getEngineAlgorithm(), getTotalNumInputChannels());
+    setLatencySamples (convolutionEngine->getLatencySamples());
+    suspendProcessing (false);
+
+    juce::Logger::writeToLog (">>> PluginProcessor - ConvolutionEngine re-prepared (mode "
+                              + juce::String ((int) getEngineAlgorithm()) + ", latency "
+                              + juce::String (convolutionEngine->getLatencySamples()) + " samples)");
+}
+
+void PluginProcessor::timerCallback()
+{
+    if (convolutionEngine == nullptr)
+        return;
+
+    if (reprepareRequested.exchange (false))
+        reprepareEngine();
+
+    if (convolutionEngine->getLatencySamples() != getLatencySamples())
+    {
+        setLatencySamples (convolutionEngine->getLatencySamples());
+        juce::Logger::writeToLog (">>> PluginProcessor - latency now " + juce::String (getLatencySamples()) + " samples");
+    }
+}
+
 void PluginProcessor::releaseResources()
 {
     // Convolution engine handles cleanup
@@ -65,12 +143,23 @@ bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 }
 
 void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, midiMessages);
+}
+
+void PluginProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, midiMessages);
+}
+
+template <typename SampleType>
+void PluginProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
 {
     static int logCount = 0;
     bool shouldLog = (logCount++ < 3);
     
     if (shouldLog)
-        juce::Logger::writeToLog (">>> PluginProcessor::processBlock #" + juce::String(logCount) + " START");
+        audioLog.post (">>> PluginProcessor::processBlock #{} START", { (double) logCount });
     
     juce::ignoreUnused (midiMessages);
     juce::ScopedNoDenormals noDenormals;
@@ -82,16 +171,10 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Midi
 
     if (shouldLog)
     {
-        juce::Logger::writeToLog (">>> processBlock channels: in=" + juce::String(totalNumInputChannels) + " out=" + juce::String(totalNumOutputChannels));
-        juce::Logger::writeToLog (">>> processBlock buffer channels: " + juce::String(buffer.getNumChannels()) + " samples: " + juce::String(buffer.getNumSamples()));
+        audioLog.post (">>> processBlock channels: in={} out={}", { (double) totalNumInputChannels, (double) totalNumOutputChannels });
+        audioLog.post (">>> processBlock buffer channels: {} samples: {}", { (double) buffer.getNumChannels(), (double) buffer.getNumSamples() });
     }
 
-    // Input level (pre-processing)
-    float inLevel = 0.0f;
-    for (int ch = 0; ch < juce::jmin(totalNumInputChannels, buffer.getNumChannels()); ++ch)
-        inLevel = juce::jmax (inLevel, buffer.getRMSLevel (ch, 0, buffer.getNumSamples()));
-    inputLevel.store (inLevel);
-
     // Generate test tone if enabled (for debugging convolution)
     if (testToneEnabled.load())
     {
@@ -104,7 +187,7 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Midi
             
             for (int i = 0; i < buffer.getNumSamples(); ++i)
             {
-                channelData[i] = 0.3f * std::sin(static_cast<float>(phase)); // 30% amplitude
+                channelData[i] = static_cast<SampleType> (0.3 * std::sin (phase)); // 30% amplitude
                 phase += phaseIncrement;
                 while (phase >= juce::MathConstants<double>::twoPi)
                     phase -= juce::MathConstants<double>::twoPi;
@@ -114,14 +197,21 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Midi
         testTonePhase += phaseIncrement * buffer.getNumSamples();
         while (testTonePhase >= juce::MathConstants<double>::twoPi)
             testTonePhase -= juce::MathConstants<double>::twoPi;
-        
-        // Update input level with test tone
-        inLevel = 0.3f;
-        inputLevel.store(inLevel);
     }
 
+    // Input level (pre-processing, test tone included): one pass gives peak, RMS and true peak
+    const float inLevel = levelMeter.measure (LevelMeter::Stage::input, buffer, totalNumInputChannels).rms;
+
     if (shouldLog)
-        juce::Logger::writeToLog (">>> processBlock input level: " + juce::String(inLevel, 4));
+        audioLog.post (">>> processBlock input level: {}", { (double) inLevel });
+
+    // Mono input on a stereo output: give the right channel the same signal, so bypass and the
+    // JUCE algorithm stay centred (partitioned mono-to-stereo convolvers only read the left)
+    if (totalNumInputChannels == 1 && totalNumOutputChannels > 1 && buffer.getNumChannels() > 1)
+        buffer.copyFrom (1, 0, buffer, 0, 0, buffer.getNumSamples());
+
+    // The engine feeds the output stage a chunk at a time as it writes it
+    levelMeter.begin (LevelMeter::Stage::output, totalNumOutputChannels);
 
     // Apply convolution to audio buffer (or pass through if bypassed/no IR)
     if (convolutionEngine)
@@ -130,12 +220,20 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Midi
         bool bypassed = convolutionEngine->isBypassed();
         
         if (shouldLog)
-            juce::Logger::writeToLog (">>> ConvEngine state: IR=" + juce::String(irLoaded ? "loaded" : "none") + " Bypass=" + juce::String(bypassed ? "ON" : "OFF"));
+            audioLog.post (irLoaded ? (bypassed ? ">>> ConvEngine state: IR=loaded Bypass=ON" : ">>> ConvEngine state: IR=loaded Bypass=OFF")
+                                    : (bypassed ? ">>> ConvEngine state: IR=none Bypass=ON" : ">>> ConvEngine state: IR=none Bypass=OFF"));
         
-        if (!irLoaded && inLevel > 0.001f)
+        static int noIrWarningCount = 0;
+        if (!irLoaded && inLevel > 0.001f && noIrWarningCount++ < 5)
         {
-            DBG("WARNING: Audio present but IR not loaded!");
+            audioLog.post ("WARNING: Audio present but IR not loaded!");
         }
+        convolutionEngine->setMorphPosition (canSizeMorph->get());
+
+        for (int source = 0; source < numBlendGains; ++source)
+            convolutionEngine->setBlendGain (source, blendGains[(size_t) source]->get());
+
+        convolutionEngine->setMix (mix->get());
         convolutionEngine->processBlock (buffer);
     }
     else
@@ -143,27 +241,23 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Midi
         // No convolution engine - ensure passthrough
         // Buffer already contains input, so we don't need to do anything
         if (shouldLog)
-            juce::Logger::writeToLog (">>> No convolution engine - passthrough");
+            audioLog.post (">>> No convolution engine - passthrough");
     }
 
-    // Convolution level (post-convolution/passthrough)
-    float convLevel = 0.0f;
-    for (int ch = 0; ch < juce::jmin(totalNumOutputChannels, buffer.getNumChannels()); ++ch)
-        convLevel = juce::jmax (convLevel, buffer.getRMSLevel (ch, 0, buffer.getNumSamples()));
-    convolutionLevel.store (convLevel);
-
-    // Output level (same as post-convolution for now)
-    outputLevel.store (convLevel);
+    // Output level (post-convolution/passthrough; finish() measures whatever the engine did not),
+    // then both stages go to the editor as one snapshot
+    const float convLevel = levelMeter.finish (LevelMeter::Stage::output, buffer).rms;
+    levelMeter.publish (buffer.getNumSamples());
     
     if (shouldLog)
-        juce::Logger::writeToLog (">>> processBlock output level: " + juce::String(convLevel, 4));
+        audioLog.post (">>> processBlock output level: {}", { (double) convLevel });
     
     // Log if we have input but no output when not bypassed
     static int noOutputWarningCount = 0;
     if (inLevel > 0.001f && convLevel < 0.0001f && convolutionEngine && !convolutionEngine->isBypassed() && noOutputWarningCount++ < 5)
     {
-        juce::Logger::writeToLog("!!! WARNING: Input present (" + juce::String(inLevel, 4) + ") but output silent (" + 
-                                 juce::String(convLevel, 4) + ") - warning #" + juce::String(noOutputWarningCount));
+        audioLog.post ("!!! WARNING: Input present ({}) but output silent ({}) - warning #{}",
+                       { (double) inLevel, (double) convLevel, (double) noOutputWarningCount });
     }
 }
 
@@ -176,6 +270,25 @@ void PluginProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     auto state = std::make_unique<juce::XmlElement>("Can_damonium");
     state->setAttribute ("version", "1.0");
+    state->setAttribute ("canSizeMorph", (double) canSizeMorph->get());
+    state->setAttribute ("mix", (double) mix->get());
+    state->setAttribute ("processingMode", (int) processingMode.load());
+    state->setAttribute ("internalBlockSize", getInternalBlockSize());
+
+    for (int source = 0; source < numBlendGains; ++source)
+        state->setAttribute ("blendGain" + juce::String (source + 1), (double) blendGains[(size_t) source]->get());
+
+    for (auto [tag, files] : { std::pair { "Blend", getBlendFiles() }, std::pair { "Morph", getMorphFiles() } })
+    {
+        if (files.isEmpty())
+            continue;
+
+        auto* sources = state->createNewChildElement (tag);
+
+        for (const auto& file : files)
+            sources->createNewChildElement ("File")->setAttribute ("path", file.getFullPathName());
+    }
+
     copyXmlToBinary (*state, destData);
 }
 
@@ -185,6 +298,43 @@ void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
     if (state != nullptr && state->hasTagName ("Can_damonium"))
     {
         // Restore state from XML
+        *canSizeMorph = (float) state->getDoubleAttribute ("canSizeMorph", canSizeMorph->get());
+        *mix = (float) state->getDoubleAttribute ("mix", mix->get());
+
+        for (int source = 0; source < numBlendGains; ++source)
+        {
+            auto& gain = *blendGains[(size_t) source];
+            gain = (float) state->getDoubleAttribute ("blendGain" + juce::String (source + 1), gain.get());
+        }
+
+        // A blend or morph is loaded again in the background, once every file is still there
+        for (auto* sources : state->getChildIterator())
+        {
+            juce::Array<juce::File> files;
+
+            for (auto* file : sources->getChildWithTagNameIterator ("File"))
+                files.add (juce::File (file->getStringAttribute ("path")));
+
+            if (files.isEmpty() || ! std::all_of (files.begin(), files.end(), [] (const juce::File& f) { return f.existsAsFile(); }))
+                continue;
+
+            if (sources->hasTagName ("Blend"))
+                loadBlend (files);
+            else if (sources->hasTagName ("Morph"))
+                loadMorph (files);
+        }
+
+        // Only recorded here: the next prepareToPlay applies them, or the timer re-prepares if already playing
+        if (state->hasAttribute ("internalBlockSize"))
+            convolutionEngine->setInternalBlockSize (state->getIntAttribute ("internalBlockSize"));
+
+        if (state->hasAttribute ("processingMode"))
+            processingMode.store ((ConvolutionEngine::Algorithm) juce::jlimit ((int) ConvolutionEngine::Algorithm::juceUniform,
+                                                                               (int) ConvolutionEngine::Algorithm::zeroLatency,
+                                                                               state->getIntAttribute ("processingMode")));
+
+        if (state->hasAttribute ("internalBlockSize") || state->hasAttribute ("processingMode"))
+            reprepareRequested.store (true);
     }
 }
 
@@ -221,10 +371,40 @@ void PluginProcessor::loadImpulseResponse (const juce::File& irFile)
     DBG("=== PluginProcessor::loadImpulseResponse END ===");
 }
 
-void PluginProcessor::loadPresetProfile (const juce::String& profileName)
+std::shared_ptr<IRLoadHandle> PluginProcessor::loadImpulseResponseAsync (const juce::File& irFile,
+                                                                         ConvolutionEngine::LoadCallback onComplete)
+{
+    DBG("=== PluginProcessor::loadImpulseResponseAsync: " + irFile.getFullPathName() + " ===");
+
+    if (convolutionEngine == nullptr)
+    {
+        DBG("  ERROR: ConvolutionEngine is null!");
+        return {};
+    }
+
+    rememberSources (IRLoadHandle::Sources::single, { irFile });
+    return convolutionEngine->loadImpulseResponseAsync (irFile, std::move (onComplete));
+}
+
+std::shared_ptr<IRLoadHandle> PluginProcessor::loadTrueStereoImpulseResponseAsync (const juce::File& leftInputFile,
+                                                                                   const juce::File& rightInputFile,
+                                                                                   ConvolutionEngine::LoadCallback onComplete)
+{
+    DBG("=== PluginProcessor::loadTrueStereoImpulseResponseAsync: " + leftInputFile.getFullPathName()
+        + " + " + rightInputFile.getFullPathName() + " ===");
+
+    if (convolutionEngine == nullptr)
+    {
+        DBG("  ERROR: ConvolutionEngine is null!");
+        return {};
+    }
+
+    rememberSources (IRLoadHandle::Sources::trueStereoPair, { leftInputFile, rightInputFile });
+    return convolutionEngine->loadTrueStereoImpulseResponseAsync (leftInputFile, rightInputFile, std::move (onComplete));
+}
+
+juce::File PluginProcessor::findPresetProfileFile (const juce::String& profileName) const
 {
-    DBG("=== loadPresetProfile START: " + profileName + " ===");
-    
     // Try to load from application resources directory
     auto appDataPath = juce::File::getSpecialLocation (juce::File::currentApplicationFile)
                             .getParentDirectory()
@@ -259,11 +439,20 @@ void PluginProcessor::loadPresetProfile (const juce::String& profileName)
     
     DBG("  Final IR path: " + irFile.getFullPathName());
     DBG("  File exists: " + juce::String(irFile.existsAsFile() ? "true" : "false"));
+    return irFile;
+}
+
+void PluginProcessor::loadPresetProfile (const juce::String& profileName)
+{
+    DBG("=== loadPresetProfile START: " + profileName + " ===");
+    
+    juce::File irFile = findPresetProfileFile (profileName);
     
     if (irFile.existsAsFile())
     {
         DBG("  SUCCESS: Loading IR from: " + irFile.getFullPathName());
-        convolutionEngine->loadImpulseResponse (irFile);
+        rememberSources (IRLoadHandle::Sources::single, { irFile });
+        convolutionEngine->loadImpulseResponseAsync (irFile);
         DBG("=== loadPresetProfile END (SUCCESS) ===");
     }
     else
@@ -273,6 +462,92 @@ void PluginProcessor::loadPresetProfile (const juce::String& profileName)
     }
 }
 
+juce::Array<juce::File> PluginProcessor::findPresetProfileFiles() const
+{
+    // Source n of a blend or morph is always PRESET_PROFILES[n], so every profile has to be there
+    juce::Array<juce::File> irFiles;
+
+    for (const auto* profileName : CanDamonium::PRESET_PROFILES)
+    {
+        auto irFile = findPresetProfileFile (profileName);
+
+        if (! irFile.existsAsFile())
+        {
+            DBG("  FAILED: Preset profile not found: " + irFile.getFullPathName());
+            return {};
+        }
+
+        irFiles.add (irFile);
+    }
+
+    return irFiles;
+}
+
+std::shared_ptr<IRLoadHandle> PluginProcessor::loadBlend (const juce::Array<juce::File>& irFiles,
+                                                          ConvolutionEngine::LoadCallback onComplete)
+{
+    DBG("=== loadBlend: " + juce::String (irFiles.size()) + " IRs ===");
+
+    if (convolutionEngine == nullptr || ! juce::isPositiveAndNotGreaterThan (irFiles.size(), numBlendGains))
+        return {};
+
+    rememberSources (IRLoadHandle::Sources::blend, irFiles);
+    return convolutionEngine->loadBlendAsync (irFiles, std::move (onComplete));
+}
+
+std::shared_ptr<IRLoadHandle> PluginProcessor::loadPresetBlend (ConvolutionEngine::LoadCallback onComplete)
+{
+    DBG("=== loadPresetBlend ===");
+    auto irFiles = findPresetProfileFiles();
+
+    if (irFiles.isEmpty())
+        return {};
+
+    return loadBlend (irFiles, std::move (onComplete));
+}
+
+void PluginProcessor::rememberSources (IRLoadHandle::Sources sources, const juce::Array<juce::File>& irFiles)
+{
+    const juce::ScopedLock sl (sourcesLock);
+    requestedSources = sources;
+    requestedFiles = irFiles;
+}
+
+juce::Array<juce::File> PluginProcessor::getBlendFiles() const
+{
+    const juce::ScopedLock sl (sourcesLock);
+    return requestedSources == IRLoadHandle::Sources::blend ? requestedFiles : juce::Array<juce::File>();
+}
+
+juce::Array<juce::File> PluginProcessor::getMorphFiles() const
+{
+    const juce::ScopedLock sl (sourcesLock);
+    return requestedSources == IRLoadHandle::Sources::morph ? requestedFiles : juce::Array<juce::File>();
+}
+
+std::shared_ptr<IRLoadHandle> PluginProcessor::loadMorph (const juce::Array<juce::File>& irFiles,
+                                                          ConvolutionEngine::LoadCallback onComplete)
+{
+    DBG("=== loadMorph: " + juce::String (irFiles.size()) + " IRs ===");
+
+    if (convolutionEngine == nullptr || irFiles.isEmpty())
+        return {};
+
+    rememberSources (IRLoadHandle::Sources::morph, irFiles);
+    return convolutionEngine->loadMorphAsync (irFiles, std::move (onComplete));
+}
+
+std::shared_ptr<IRLoadHandle> PluginProcessor::loadPresetMorph (ConvolutionEngine::LoadCallback onComplete)
+{
+    DBG("=== loadPresetMorph ===");
+    auto irFiles = findPresetProfileFiles();
+
+    if (irFiles.isEmpty())
+        return {};
+
+    return loadMorph (irFiles, std::move (onComplete));
+}
+
 void PluginProcessor::saveCurrentIRToLibrary (const juce::String& fileName)
 {
     // TODO: Implement saving IR to user library
@@ -3,8 +3,10 @@
 #include <JuceHeader.h>
 #include "ConvolutionEngine.h"
 #include "IRLibraryManager.h"
+#include "LevelMeter.h"
 
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        private juce::Timer
 {
 public:
     PluginProcessor();
@@ -15,6 +17,10 @@ public:
     void releaseResources() override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // The engine converts double samples inside its own copies, so hosts need not convert around us
+    bool supportsDoublePrecisionProcessing() const override { return true; }
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     //==============================================================================
@@ -27,7 +33,7 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override { return convolutionEngine != nullptr ? convolutionEngine->getTailLengthSeconds() : 0.0; }
 
     //==============================================================================
     int getNumPrograms() override { return 1; }
@@ -43,12 +49,40 @@ public:
     //==============================================================================
     // IR Management
     void loadImpulseResponse (const juce::File& irFile);
+    std::shared_ptr<IRLoadHandle> loadImpulseResponseAsync (const juce::File& irFile,
+                                                            ConvolutionEngine::LoadCallback onComplete = {});
+    std::shared_ptr<IRLoadHandle> loadTrueStereoImpulseResponseAsync (const juce::File& leftInputFile,
+                                                                      const juce::File& rightInputFile,
+                                                                      ConvolutionEngine::LoadCallback onComplete = {});
     void setDeferredIRLoad (const juce::File& irFile) noexcept 
     { 
         if (convolutionEngine) 
             convolutionEngine->setDeferredIRLoad(irFile); 
     }
     void loadPresetProfile (const juce::String& profileName);
+
+    // Mixes several IRs through one convolver; source n follows the "Blend Gain n+1" parameter
+    static constexpr int numBlendGains = 3;
+    std::shared_ptr<IRLoadHandle> loadBlend (const juce::Array<juce::File>& irFiles,
+                                             ConvolutionEngine::LoadCallback onComplete = {});
+
+    // Blends the Small, Regular and Grande profiles; source n of the blend is PRESET_PROFILES[n]
+    std::shared_ptr<IRLoadHandle> loadPresetBlend (ConvolutionEngine::LoadCallback onComplete = {});
+    juce::Array<juce::File> getPresetProfileFiles() const { return findPresetProfileFiles(); }
+    juce::AudioParameterFloat& getBlendGainParameter (int source) noexcept { return *blendGains[(size_t) source]; }
+
+    // The files of the blend or morph last asked for, saved with the state; empty after a single IR load
+    juce::Array<juce::File> getBlendFiles() const;
+    juce::Array<juce::File> getMorphFiles() const;
+
+    // Interpolates between several IRs in the frequency domain, driven by the "Can Size Morph" parameter
+    std::shared_ptr<IRLoadHandle> loadMorph (const juce::Array<juce::File>& irFiles,
+                                             ConvolutionEngine::LoadCallback onComplete = {});
+
+    // Morphs the three profiles: 0 is Small, 0.5 Regular and 1 Grande. The editor's can size selector loads it.
+    std::shared_ptr<IRLoadHandle> loadPresetMorph (ConvolutionEngine::LoadCallback onComplete = {});
+    juce::AudioParameterFloat& getCanSizeMorphParameter() noexcept { return *canSizeMorph; }
+    bool isMorphLoaded() const noexcept { return convolutionEngine != nullptr && convolutionEngine->isMorphLoaded(); }
     void saveCurrentIRToLibrary (const juce::String& fileName);
     
     IRLibraryManager& getIRLibrary() noexcept { return irLibrary; }
@@ -85,6 +119,48 @@ public:
     {
         return convolutionEngine ? convolutionEngine->isIrResampleEnabled() : false;
     }
+
+    // Auto-trim floor in dB; 0 turns trimming off. Applies from the next IR load.
+    void setAutoTrimFloor (float floorDb) noexcept
+    {
+        if (convolutionEngine)
+        {
+            convolutionEngine->setAutoTrimEnabled (floorDb < 0.0f);
+            convolutionEngine->setAutoTrimFloor (floorDb);
+        }
+    }
+
+    float getAutoTrimFloor() const noexcept
+    {
+        return convolutionEngine != nullptr && convolutionEngine->isAutoTrimEnabled() ? convolutionEngine->getAutoTrimFloor() : 0.0f;
+    }
+
+    // Converts IRs to minimum phase as they load, so they trim shorter
+    void setMinimumPhaseEnabled (bool enabled) noexcept
+    {
+        if (convolutionEngine)
+            convolutionEngine->setIRTransform (enabled ? ConvolutionEngine::IRTransform::minimumPhase : ConvolutionEngine::IRTransform::none);
+    }
+
+    bool isMinimumPhaseEnabled() const noexcept
+    {
+        return convolutionEngine != nullptr && convolutionEngine->getIRTransform() == ConvolutionEngine::IRTransform::minimumPhase;
+    }
+
+    /** Switches the convolution algorithm or the engine's internal block size. Once playing, the engine is re-prepared with processing
+        suspended; the old convolver plays on until the rebuilt one replaces it, and the host is told the new latency only then, so its
+        delay compensation follows what is heard. */
+    void setProcessingMode (ConvolutionEngine::Algorithm mode);
+    ConvolutionEngine::Algorithm getProcessingMode() const noexcept { return processingMode.load(); }
+    void setInternalBlockSize (int numSamples);
+    int getInternalBlockSize() const noexcept { return convolutionEngine ? convolutionEngine->getInternalBlockSize() : 0; }
+
+    juce::AudioParameterFloat& getMixParameter() noexcept { return *mix; }
+
+    ConvolutionEngine::TrimReport getTrimReport() const
+    {
+        return convolutionEngine ? convolutionEngine->getTrimReport() : ConvolutionEngine::TrimReport();
+    }
     
     //==============================================================================
     // Test tone generator (for debugging)
@@ -92,10 +168,9 @@ public:
     bool isTestToneEnabled() const noexcept { return testToneEnabled.load(); }
 
     //==============================================================================
-    // Level meters (linear 0.0 - 1.0)
-    float getInputLevel() const noexcept { return inputLevel.load(); }
-    float getConvolutionLevel() const noexcept { return convolutionLevel.load(); }
-    float getOutputLevel() const noexcept { return outputLevel.load(); }
+    // Level meters (linear, 1.0 = full scale), input and output from the same block
+    LevelMeter::Snapshot getMeterSnapshot() const noexcept { return levelMeter.getSnapshot(); }
+    void resetMeterClips() noexcept { levelMeter.resetClips(); }
 
     // Audio callback diagnostics
     uint64_t getAudioCallbackCount() const noexcept { return audioCallbackCount.load(); }
@@ -103,21 +178,56 @@ public:
     int getLastLayoutInputs() const noexcept { return lastLayoutInputs.load(); }
     int getLastLayoutOutputs() const noexcept { return lastLayoutOutputs.load(); }
 
+    // Tail segment scheduling counters
+    ConvolutionWorkerPool::Stats getConvolutionWorkerStats() const noexcept
+    {
+        return convolutionEngine ? convolutionEngine->getWorkerStats() : ConvolutionWorkerPool::Stats();
+    }
+
+    ConvolutionEngine::BlockCost getConvolutionBlockCost() const noexcept
+    {
+        return convolutionEngine ? convolutionEngine->getBlockCost() : ConvolutionEngine::BlockCost();
+    }
+
 private:
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+    void reprepareEngine();
+    void timerCallback() override;
+    ConvolutionEngine::Algorithm getEngineAlgorithm() const noexcept;
+
+    juce::File findPresetProfileFile (const juce::String& profileName) const;
+    juce::Array<juce::File> findPresetProfileFiles() const;   // Empty unless every profile exists
+    void rememberSources (IRLoadHandle::Sources sources, const juce::Array<juce::File>& irFiles);
+
     std::unique_ptr<ConvolutionEngine> convolutionEngine;
     IRLibraryManager irLibrary;
+    juce::AudioParameterFloat* canSizeMorph = nullptr;   // Owned by the processor
+    juce::AudioParameterFloat* mix = nullptr;            // Owned by the processor
+    std::array<juce::AudioParameterFloat*, numBlendGains> blendGains {};   // Owned by the processor
+    std::atomic<ConvolutionEngine::Algorithm> processingMode;
+
+    // What the last load asked for, so a session reopens with the same blend or morph
+    mutable juce::CriticalSection sourcesLock;
+    IRLoadHandle::Sources requestedSources = IRLoadHandle::Sources::single;
+    juce::Array<juce::File> requestedFiles;
+
+    // Set by setStateInformation, which may run on any thread; the timer re-prepares on the message thread
+    std::atomic<bool> reprepareRequested { false };
+    static constexpr int latencyPollHz = 20;
 
     std::atomic<double> currentSampleRateHz { 0.0 };
     std::atomic<int> currentBlockSize { 0 };
 
-    std::atomic<float> inputLevel { 0.0f };
-    std::atomic<float> convolutionLevel { 0.0f };
-    std::atomic<float> outputLevel { 0.0f };
+    LevelMeter levelMeter;
 
     std::atomic<uint64_t> audioCallbackCount { 0 };
     std::atomic<int> prepareToPlayCount { 0 };
     mutable std::atomic<int> lastLayoutInputs { -1 };
     mutable std::atomic<int> lastLayoutOutputs { -1 };
+
+    // Diagnostics posted from processBlock
+    AudioLogger audioLog;
     
     // Test tone generation
     std::atomic<bool> testToneEnabled { false };
@@ -0,0 +1,201 @@
+#include "PolyphaseResampler.h"
+#include <numeric>
+
+namespace
+{
+    // Helper threads shared by every resample in the process, so concurrent loads in several
+    // instances queue for them instead of each starting a thread per channel
+    struct ResampleThreads
+    {
+        static constexpr int maxThreads = 8;
+        juce::ThreadPool pool { juce::jlimit (1, maxThreads, juce::SystemStats::getNumCpus() - 1) };
+    };
+
+    // One resample's channels, claimed one at a time by the calling thread and the helpers.
+    // Helpers that start after every channel is claimed touch nothing but this.
+    struct ChannelWork
+    {
+        const PolyphaseResampler* resampler = nullptr;
+        const juce::AudioBuffer<float>* input = nullptr;
+        juce::AudioBuffer<float>* output = nullptr;
+        int numChannels = 0;
+        std::atomic<int> nextChannel { 0 };
+        std::atomic<int> numChannelsDone { 0 };
+        juce::WaitableEvent finished;
+
+        void run()
+        {
+            for (int ch = nextChannel++; ch < numChannels; ch = nextChannel++)
+            {
+                resampler->process (input->getReadPointer (ch), input->getNumSamples(), output->getWritePointer (ch));
+
+                if (++numChannelsDone == numChannels)
+                    finished.signal();
+            }
+        }
+    };
+
+    struct QualitySettings
+    {
+        int numTaps;            // Taps per phase when upsampling; downsampling widens by the ratio
+        double rejectionDb;
+    };
+
+    QualitySettings getQualitySettings (PolyphaseResampler::Quality quality) noexcept
+    {
+        switch (quality)
+        {
+            case PolyphaseResampler::Quality::fast:     return { 32, 80.0 };
+            case PolyphaseResampler::Quality::balanced: return { 64, 100.0 };
+            case PolyphaseResampler::Quality::best:     return { 128, 120.0 };
+        }
+
+        return { 64, 100.0 };
+    }
+
+    // Zeroth-order modified Bessel function of the first kind, by its power series
+    double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        const double quarterSquare = 0.25 * x * x;
+
+        for (int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+        {
+            term *= quarterSquare / ((double) k * (double) k);
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    double sinc (double x) noexcept
+    {
+        return std::abs (x) < 1.0e-12 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+    }
+}
+
+//==============================================================================
+PolyphaseResampler::PolyphaseResampler (double sourceSampleRate, double targetSampleRate, Quality quality,
+                                        const SimdKernels::KernelTable& kernelsToUse)
+    : kernels (kernelsToUse)
+{
+    jassert (sourceSampleRate > 0.0 && targetSampleRate > 0.0);
+
+    // Whole-number rates reduce exactly (48000 -> 44100 is 147 / 160); anything else takes the nearest ratio that fits
+    const auto source = (juce::int64) std::llround (sourceSampleRate);
+    const auto target = (juce::int64) std::llround (targetSampleRate);
+    const auto divisor = std::gcd (source, target);
+    upsampling = (int) (target / divisor);
+    downsampling = (int) (source / divisor);
+
+    if (upsampling > maxPhases || std::abs ((double) source - sourceSampleRate) > 1.0e-6 || std::abs ((double) target - targetSampleRate) > 1.0e-6)
+    {
+        upsampling = maxPhases;
+        downsampling = juce::jmax (1, (int) std::llround (maxPhases * sourceSampleRate / targetSampleRate));
+    }
+
+    // Widen the filter by the downsampling ratio so the transition band stays the same share of the output Nyquist
+    const auto settings = getQualitySettings (quality);
+    const double ratio = (double) upsampling / (double) downsampling;
+    const int numTaps = (int) std::ceil (settings.numTaps * juce::jmax (1.0, 1.0 / ratio));
+    tapsPerPhase = (numTaps + 15) & ~15;
+    tapsBeforeCentre = numTaps / 2 - 1;
+
+    // Kaiser design: the transition band the taps allow, ending at the lower Nyquist frequency (cycles per input sample)
+    const double nyquist = 0.5 * juce::jmin (1.0, ratio);
+    const double transition = (settings.rejectionDb - 7.95) / (14.36 * (double) (numTaps - 1));
+    const double cutoff = juce::jmax (0.05 * nyquist, nyquist - 0.5 * transition);
+    const double beta = 0.1102 * (settings.rejectionDb - 8.7);
+    const double halfWidth = 0.5 * (double) numTaps;
+    const double windowScale = 1.0 / besselI0 (beta);
+
+    phases.assign ((size_t) upsampling * (size_t) tapsPerPhase, 0.0f);
+
+    for (int phase = 0; phase < upsampling; ++phase)
+    {
+        auto* taps = phases.data() + (size_t) phase * (size_t) tapsPerPhase;
+        const double fraction = (double) phase / (double) upsampling;
+        double sum = 0.0;
+
+        // Tap k reads the input sample (k - tapsBeforeCentre) after the one at or before the output position
+        std::vector<double> weights ((size_t) numTaps);
+
+        for (int k = 0; k < numTaps; ++k)
+        {
+            const double distance = fraction + (double) (tapsBeforeCentre - k);
+            const double normalised = distance / halfWidth;
+            const double window = std::abs (normalised) < 1.0 ? besselI0 (beta * std::sqrt (1.0 - normalised * normalised)) * windowScale : 0.0;
+            weights[(size_t) k] = 2.0 * cutoff * sinc (2.0 * cutoff * distance) * window;
+            sum += weights[(size_t) k];
+        }
+
+        // Every phase passes DC at exactly unity, so no ripple at the phase rate
+        for (int k = 0; k < numTaps; ++k)
+            taps[k] = (float) (weights[(size_t) k] / sum);
+    }
+}
+
+int PolyphaseResampler::getOutputLength (int numInputSamples) const noexcept
+{
+    return (int) (((juce::int64) numInputSamples * upsampling + downsampling - 1) / downsampling);
+}
+
+void PolyphaseResampler::process (const float* input, int numInputSamples, float* output) const
+{
+    const int numOutputSamples = getOutputLength (numInputSamples);
+
+    // Zeros either side, so every dot product reads tapsPerPhase valid samples
+    std::vector<float> padded ((size_t) (numInputSamples + 2 * tapsPerPhase), 0.0f);
+    std::copy_n (input, numInputSamples, padded.data() + tapsPerPhase);
+    const auto* start = padded.data() + tapsPerPhase - tapsBeforeCentre;
+
+    juce::int64 position = 0;   // Output sample times downsampling, in units of 1 / upsampling input samples
+
+    for (int n = 0; n < numOutputSamples; ++n, position += downsampling)
+    {
+        const auto base = position / upsampling;
+        const auto phase = (int) (position - base * upsampling);
+        output[n] = kernels.dotProduct (phases.data() + (size_t) phase * (size_t) tapsPerPhase, start + base, tapsPerPhase);
+    }
+}
+
+juce::AudioBuffer<float> PolyphaseResampler::resample (const juce::AudioBuffer<float>& input, double sourceSampleRate,
+                                                       double targetSampleRate, Quality quality, int maxThreads)
+{
+    const PolyphaseResampler resampler (sourceSampleRate, targetSampleRate, quality);
+    const int numChannels = input.getNumChannels();
+    juce::AudioBuffer<float> output (numChannels, resampler.getOutputLength (input.getNumSamples()));
+
+    if (numChannels == 0)
+        return output;
+
+    // Channels are independent; the calling thread works through them too, so it never waits
+    // for a helper that has not started
+    juce::SharedResourcePointer<ResampleThreads> threads;
+    const int numHelpers = juce::jmin (juce::jlimit (1, numChannels, maxThreads) - 1, threads->pool.getNumThreads());
+
+    auto work = std::make_shared<ChannelWork>();
+    work->resampler = &resampler;
+    work->input = &input;
+    work->output = &output;
+    work->numChannels = numChannels;
+
+    for (int i = 0; i < numHelpers; ++i)
+        threads->pool.addJob ([work] { work->run(); });
+
+    work->run();
+    work->finished.wait();
+    return output;
+}
+
+const char* PolyphaseResampler::getQualityName (Quality quality) noexcept
+{
+    switch (quality)
+    {
+        case Quality::fast:     return "fast";
+        case Quality::balanced: return "balanced";
+        case Quality::best:     return "best";
+    }
+
+    return "";
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "SimdKernels.h"
+
+/**
+ * Windowed-sinc sample rate conversion for whole buffers, used to match IRs to the device rate.
+ *
+ * The rates are reduced to a ratio of upsampling L to downsampling M, and a Kaiser-windowed
+ * sinc is split into L phases of a few dozen taps. Each output sample is then a single dot
+ * product of one phase with the input around it. The cutoff is placed so the stopband starts
+ * exactly at the lower of the two Nyquist frequencies, so nothing above it aliases back in
+ * above the preset's rejection. Rates that do not reduce to at most maxPhases phases use the
+ * nearest such ratio, which stretches the result by less than 1 / (2 * maxPhases).
+ *
+ * Output sample 0 lines up with input sample 0, so resampled IRs keep their onset.
+ */
+class PolyphaseResampler
+{
+public:
+    enum class Quality
+    {
+        fast,       // 32 taps, 80 dB rejection, passband to about 68% of Nyquist
+        balanced,   // 64 taps, 100 dB rejection, passband to about 80% of Nyquist
+        best        // 128 taps, 120 dB rejection, passband to about 88% of Nyquist
+    };
+
+    static constexpr int maxPhases = 4096;
+
+    PolyphaseResampler (double sourceSampleRate, double targetSampleRate, Quality quality,
+                        const SimdKernels::KernelTable& kernelsToUse = SimdKernels::selectKernels());
+
+    // ceil (numInputSamples * target / source), as the Lagrange path produced
+    int getOutputLength (int numInputSamples) const noexcept;
+
+    // Reads numInputSamples and writes getOutputLength (numInputSamples) samples; safe to call from several threads
+    void process (const float* input, int numInputSamples, float* output) const;
+
+    /** Resamples every channel of a buffer, spreading the channels over up to maxThreads threads:
+        the calling thread and helpers from a small pool shared by the whole process. */
+    static juce::AudioBuffer<float> resample (const juce::AudioBuffer<float>& input, double sourceSampleRate,
+                                              double targetSampleRate, Quality quality,
+                                              int maxThreads = juce::SystemStats::getNumCpus());
+
+    static const char* getQualityName (Quality quality) noexcept;
+
+    int getUpsamplingFactor() const noexcept { return upsampling; }
+    int getDownsamplingFactor() const noexcept { return downsampling; }
+    int getNumTapsPerPhase() const noexcept { return tapsPerPhase; }
+
+private:
+    SimdKernels::KernelTable kernels;
+    int upsampling = 1;
+    int downsampling = 1;
+    int tapsPerPhase = 0;        // Padded to a multiple of 16 so every dot product runs at full width
+    int tapsBeforeCentre = 0;    // Input samples read before the one at or before each output position
+    std::vector<float> phases;   // upsampling runs of tapsPerPhase taps, in input order
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
@@ -0,0 +1,565 @@
+#include "SimdKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+
+ // GCC and Clang need per-function target attributes to emit wider instructions
+ // than the translation unit was compiled for. MSVC accepts the intrinsics as-is.
+ #if JUCE_GCC || JUCE_CLANG
+  #define CAN_DAMONIUM_TARGET(isa) __attribute__ ((target (isa)))
+ #else
+  #define CAN_DAMONIUM_TARGET(isa)
+ #endif
+#endif
+
+namespace
+{
+    //==============================================================================
+    void firScalar (const float* reversedTaps, int numTaps, const float* input, float* output, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float sum = 0.0f;
+
+            for (int k = 0; k < numTaps; ++k)
+                sum += reversedTaps[k] * input[i + k];
+
+            output[i] += sum;
+        }
+    }
+
+    void complexMacScalar (const float* x, const float* h, float* acc, int numBins) noexcept
+    {
+        const auto* xIm = x + numBins;
+        const auto* hIm = h + numBins;
+        auto* accIm = acc + numBins;
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            acc[k]   += x[k] * h[k] - xIm[k] * hIm[k];
+            accIm[k] += x[k] * hIm[k] + xIm[k] * h[k];
+        }
+    }
+
+    float dotProductScalar (const float* a, const float* b, int numSamples) noexcept
+    {
+        float sum = 0.0f;
+
+        for (int k = 0; k < numSamples; ++k)
+            sum += a[k] * b[k];
+
+        return sum;
+    }
+
+    void meterScalar (const float* input, int numSamples, const float* reversedPhaseTaps,
+                      int numPhases, int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            sums.peak = juce::jmax (sums.peak, std::abs (input[i]));
+            sums.sumSquares += input[i] * input[i];
+
+            for (int phase = 0; phase < numPhases; ++phase)
+            {
+                const auto* taps = reversedPhaseTaps + phase * numTaps;
+                float sum = 0.0f;
+
+                for (int k = 0; k < numTaps; ++k)
+                    sum += taps[k] * input[i - numTaps + 1 + k];
+
+                sums.interpolatedPeak = juce::jmax (sums.interpolatedPeak, std::abs (sum));
+            }
+        }
+    }
+
+   #if JUCE_INTEL
+    //==============================================================================
+    // Vectorised across output samples: each tap is broadcast and multiplied into
+    // a run of consecutive outputs, so no horizontal sums are needed.
+    CAN_DAMONIUM_TARGET ("sse2")
+    void firSse2 (const float* reversedTaps, int numTaps, const float* input, float* output, int numSamples) noexcept
+    {
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            auto sum0 = _mm_setzero_ps();
+            auto sum1 = _mm_setzero_ps();
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto tap = _mm_set1_ps (reversedTaps[k]);
+                sum0 = _mm_add_ps (sum0, _mm_mul_ps (tap, _mm_loadu_ps (input + i + k)));
+                sum1 = _mm_add_ps (sum1, _mm_mul_ps (tap, _mm_loadu_ps (input + i + k + 4)));
+            }
+
+            _mm_storeu_ps (output + i,     _mm_add_ps (_mm_loadu_ps (output + i), sum0));
+            _mm_storeu_ps (output + i + 4, _mm_add_ps (_mm_loadu_ps (output + i + 4), sum1));
+        }
+
+        firScalar (reversedTaps, numTaps, input + i, output + i, numSamples - i);
+    }
+
+    CAN_DAMONIUM_TARGET ("avx2,fma")
+    void firAvx2 (const float* reversedTaps, int numTaps, const float* input, float* output, int numSamples) noexcept
+    {
+        int i = 0;
+
+        for (; i + 16 <= numSamples; i += 16)
+        {
+            auto sum0 = _mm256_setzero_ps();
+            auto sum1 = _mm256_setzero_ps();
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto tap = _mm256_broadcast_ss (reversedTaps + k);
+                sum0 = _mm256_fmadd_ps (tap, _mm256_loadu_ps (input + i + k), sum0);
+                sum1 = _mm256_fmadd_ps (tap, _mm256_loadu_ps (input + i + k + 8), sum1);
+            }
+
+            _mm256_storeu_ps (output + i,     _mm256_add_ps (_mm256_loadu_ps (output + i), sum0));
+            _mm256_storeu_ps (output + i + 8, _mm256_add_ps (_mm256_loadu_ps (output + i + 8), sum1));
+        }
+
+        firSse2 (reversedTaps, numTaps, input + i, output + i, numSamples - i);
+    }
+
+    CAN_DAMONIUM_TARGET ("avx512f")
+    void firAvx512 (const float* reversedTaps, int numTaps, const float* input, float* output, int numSamples) noexcept
+    {
+        int i = 0;
+
+        for (; i + 32 <= numSamples; i += 32)
+        {
+            auto sum0 = _mm512_setzero_ps();
+            auto sum1 = _mm512_setzero_ps();
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto tap = _mm512_set1_ps (reversedTaps[k]);
+                sum0 = _mm512_fmadd_ps (tap, _mm512_loadu_ps (input + i + k), sum0);
+                sum1 = _mm512_fmadd_ps (tap, _mm512_loadu_ps (input + i + k + 16), sum1);
+            }
+
+            _mm512_storeu_ps (output + i,      _mm512_add_ps (_mm512_loadu_ps (output + i), sum0));
+            _mm512_storeu_ps (output + i + 16, _mm512_add_ps (_mm512_loadu_ps (output + i + 16), sum1));
+        }
+
+        // EVEX to VEX needs no transition, so the AVX2 loop takes what is left
+        firAvx2 (reversedTaps, numTaps, input + i, output + i, numSamples - i);
+    }
+
+    //==============================================================================
+    // Two accumulators hide the add latency; the horizontal sum runs once at the end
+    CAN_DAMONIUM_TARGET ("sse2")
+    float dotProductSse2 (const float* a, const float* b, int numSamples) noexcept
+    {
+        auto sum0 = _mm_setzero_ps();
+        auto sum1 = _mm_setzero_ps();
+        int k = 0;
+
+        for (; k + 8 <= numSamples; k += 8)
+        {
+            sum0 = _mm_add_ps (sum0, _mm_mul_ps (_mm_loadu_ps (a + k),     _mm_loadu_ps (b + k)));
+            sum1 = _mm_add_ps (sum1, _mm_mul_ps (_mm_loadu_ps (a + k + 4), _mm_loadu_ps (b + k + 4)));
+        }
+
+        auto sum = _mm_add_ps (sum0, sum1);
+        sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+        sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+        float result = _mm_cvtss_f32 (sum);
+
+        for (; k < numSamples; ++k)
+            result += a[k] * b[k];
+
+        return result;
+    }
+
+    CAN_DAMONIUM_TARGET ("avx2,fma")
+    float dotProductAvx2 (const float* a, const float* b, int numSamples) noexcept
+    {
+        auto sum0 = _mm256_setzero_ps();
+        auto sum1 = _mm256_setzero_ps();
+        int k = 0;
+
+        for (; k + 16 <= numSamples; k += 16)
+        {
+            sum0 = _mm256_fmadd_ps (_mm256_loadu_ps (a + k),     _mm256_loadu_ps (b + k),     sum0);
+            sum1 = _mm256_fmadd_ps (_mm256_loadu_ps (a + k + 8), _mm256_loadu_ps (b + k + 8), sum1);
+        }
+
+        // The tail stays in this function: calling into non-VEX code with the upper lanes dirty
+        // costs far more than a short dot product
+        const auto sum = _mm256_add_ps (sum0, sum1);
+        auto half = _mm_add_ps (_mm256_castps256_ps128 (sum), _mm256_extractf128_ps (sum, 1));
+        half = _mm_add_ps (half, _mm_movehl_ps (half, half));
+        half = _mm_add_ss (half, _mm_shuffle_ps (half, half, 1));
+        float result = _mm_cvtss_f32 (half);
+
+        for (; k < numSamples; ++k)
+            result += a[k] * b[k];
+
+        return result;
+    }
+
+    CAN_DAMONIUM_TARGET ("avx512f")
+    float dotProductAvx512 (const float* a, const float* b, int numSamples) noexcept
+    {
+        auto sum0 = _mm512_setzero_ps();
+        auto sum1 = _mm512_setzero_ps();
+        int k = 0;
+
+        for (; k + 32 <= numSamples; k += 32)
+        {
+            sum0 = _mm512_fmadd_ps (_mm512_loadu_ps (a + k),      _mm512_loadu_ps (b + k),      sum0);
+            sum1 = _mm512_fmadd_ps (_mm512_loadu_ps (a + k + 16), _mm512_loadu_ps (b + k + 16), sum1);
+        }
+
+        // Masked loads take the last partial vectors, so there is no scalar tail at all
+        for (; k < numSamples; k += 16)
+        {
+            const auto mask = (__mmask16) (numSamples - k >= 16 ? 0xffff : (1u << (numSamples - k)) - 1u);
+            sum0 = _mm512_fmadd_ps (_mm512_maskz_loadu_ps (mask, a + k), _mm512_maskz_loadu_ps (mask, b + k), sum0);
+        }
+
+        return _mm512_reduce_add_ps (_mm512_add_ps (sum0, sum1));
+    }
+
+    //==============================================================================
+    // Every level comes out of one read of the block. Each input load feeds all the interpolator
+    // phase (up to three), whose sums run side by side rather than as one long chain, and the three
+    // results are reduced across lanes once at the end.
+    template <int numPhases>
+    CAN_DAMONIUM_TARGET ("sse2")
+    void meterSse2Phases (const float* input, int numSamples, const float* reversedPhaseTaps,
+                          int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        const auto signMask = _mm_set1_ps (-0.0f);
+        auto peak = _mm_setzero_ps();
+        auto sumSquares = _mm_setzero_ps();
+        auto interpolatedPeak = _mm_setzero_ps();
+        const auto* history = input - numTaps + 1;
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const auto x = _mm_loadu_ps (input + i);
+            peak = _mm_max_ps (peak, _mm_andnot_ps (signMask, x));
+            sumSquares = _mm_add_ps (sumSquares, _mm_mul_ps (x, x));
+
+            auto sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps(), sum2 = _mm_setzero_ps();
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto in = _mm_loadu_ps (history + i + k);
+                sum0 = _mm_add_ps (sum0, _mm_mul_ps (_mm_set1_ps (reversedPhaseTaps[k]), in));
+
+                if constexpr (numPhases > 1)
+                    sum1 = _mm_add_ps (sum1, _mm_mul_ps (_mm_set1_ps (reversedPhaseTaps[numTaps + k]), in));
+
+                if constexpr (numPhases > 2)
+                    sum2 = _mm_add_ps (sum2, _mm_mul_ps (_mm_set1_ps (reversedPhaseTaps[2 * numTaps + k]), in));
+            }
+
+            interpolatedPeak = _mm_max_ps (interpolatedPeak, _mm_andnot_ps (signMask, sum0));
+
+            if constexpr (numPhases > 1)
+                interpolatedPeak = _mm_max_ps (interpolatedPeak, _mm_andnot_ps (signMask, sum1));
+
+            if constexpr (numPhases > 2)
+                interpolatedPeak = _mm_max_ps (interpolatedPeak, _mm_andnot_ps (signMask, sum2));
+        }
+
+        alignas (16) float lanes[3][4];
+        _mm_store_ps (lanes[0], peak);
+        _mm_store_ps (lanes[1], sumSquares);
+        _mm_store_ps (lanes[2], interpolatedPeak);
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            sums.peak = juce::jmax (sums.peak, lanes[0][lane]);
+            sums.sumSquares += lanes[1][lane];
+            sums.interpolatedPeak = juce::jmax (sums.interpolatedPeak, lanes[2][lane]);
+        }
+
+        meterScalar (input + i, numSamples - i, reversedPhaseTaps, numPhases, numTaps, sums);
+    }
+
+    template <int numPhases>
+    CAN_DAMONIUM_TARGET ("avx2,fma")
+    void meterAvx2Phases (const float* input, int numSamples, const float* reversedPhaseTaps,
+                          int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        const auto signMask = _mm256_set1_ps (-0.0f);
+        auto peak = _mm256_setzero_ps();
+        auto sumSquares = _mm256_setzero_ps();
+        auto interpolatedPeak = _mm256_setzero_ps();
+        const auto* history = input - numTaps + 1;
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const auto x = _mm256_loadu_ps (input + i);
+            peak = _mm256_max_ps (peak, _mm256_andnot_ps (signMask, x));
+            sumSquares = _mm256_fmadd_ps (x, x, sumSquares);
+
+            auto sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps(), sum2 = _mm256_setzero_ps();
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto in = _mm256_loadu_ps (history + i + k);
+                sum0 = _mm256_fmadd_ps (_mm256_broadcast_ss (reversedPhaseTaps + k), in, sum0);
+
+                if constexpr (numPhases > 1)
+                    sum1 = _mm256_fmadd_ps (_mm256_broadcast_ss (reversedPhaseTaps + numTaps + k), in, sum1);
+
+                if constexpr (numPhases > 2)
+                    sum2 = _mm256_fmadd_ps (_mm256_broadcast_ss (reversedPhaseTaps + 2 * numTaps + k), in, sum2);
+            }
+
+            interpolatedPeak = _mm256_max_ps (interpolatedPeak, _mm256_andnot_ps (signMask, sum0));
+
+            if constexpr (numPhases > 1)
+                interpolatedPeak = _mm256_max_ps (interpolatedPeak, _mm256_andnot_ps (signMask, sum1));
+
+            if constexpr (numPhases > 2)
+                interpolatedPeak = _mm256_max_ps (interpolatedPeak, _mm256_andnot_ps (signMask, sum2));
+        }
+
+        alignas (32) float lanes[3][8];
+        _mm256_store_ps (lanes[0], peak);
+        _mm256_store_ps (lanes[1], sumSquares);
+        _mm256_store_ps (lanes[2], interpolatedPeak);
+        _mm256_zeroupper();
+
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            sums.peak = juce::jmax (sums.peak, lanes[0][lane]);
+            sums.sumSquares += lanes[1][lane];
+            sums.interpolatedPeak = juce::jmax (sums.interpolatedPeak, lanes[2][lane]);
+        }
+
+        // Upper lanes are clean again, so the tail can share the scalar loop
+        meterScalar (input + i, numSamples - i, reversedPhaseTaps, numPhases, numTaps, sums);
+    }
+
+    template <int numPhases>
+    CAN_DAMONIUM_TARGET ("avx512f")
+    void meterAvx512Phases (const float* input, int numSamples, const float* reversedPhaseTaps,
+                            int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        auto peak = _mm512_setzero_ps();
+        auto sumSquares = _mm512_setzero_ps();
+        auto interpolatedPeak = _mm512_setzero_ps();
+        const auto* history = input - numTaps + 1;
+
+        // Masked loads zero the lanes past the end, which change none of the levels, so the
+        // last partial vector goes through the same loop
+        for (int i = 0; i < numSamples; i += 16)
+        {
+            const auto mask = (__mmask16) (numSamples - i >= 16 ? 0xffff : (1u << (numSamples - i)) - 1u);
+            const auto x = _mm512_maskz_loadu_ps (mask, input + i);
+            peak = _mm512_max_ps (peak, _mm512_abs_ps (x));
+            sumSquares = _mm512_fmadd_ps (x, x, sumSquares);
+
+            auto sum0 = _mm512_setzero_ps(), sum1 = _mm512_setzero_ps(), sum2 = _mm512_setzero_ps();
+
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const auto in = _mm512_maskz_loadu_ps (mask, history + i + k);
+                sum0 = _mm512_fmadd_ps (_mm512_set1_ps (reversedPhaseTaps[k]), in, sum0);
+
+                if constexpr (numPhases > 1)
+                    sum1 = _mm512_fmadd_ps (_mm512_set1_ps (reversedPhaseTaps[numTaps + k]), in, sum1);
+
+                if constexpr (numPhases > 2)
+                    sum2 = _mm512_fmadd_ps (_mm512_set1_ps (reversedPhaseTaps[2 * numTaps + k]), in, sum2);
+            }
+
+            interpolatedPeak = _mm512_max_ps (interpolatedPeak, _mm512_abs_ps (sum0));
+
+            if constexpr (numPhases > 1)
+                interpolatedPeak = _mm512_max_ps (interpolatedPeak, _mm512_abs_ps (sum1));
+
+            if constexpr (numPhases > 2)
+                interpolatedPeak = _mm512_max_ps (interpolatedPeak, _mm512_abs_ps (sum2));
+        }
+
+        sums.peak = juce::jmax (sums.peak, _mm512_reduce_max_ps (peak));
+        sums.sumSquares += _mm512_reduce_add_ps (sumSquares);
+        sums.interpolatedPeak = juce::jmax (sums.interpolatedPeak, _mm512_reduce_max_ps (interpolatedPeak));
+    }
+
+    void meterSse2 (const float* input, int numSamples, const float* reversedPhaseTaps,
+                    int numPhases, int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        switch (numPhases)
+        {
+            case 1:  return meterSse2Phases<1> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            case 2:  return meterSse2Phases<2> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            case 3:  return meterSse2Phases<3> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            default: return meterScalar (input, numSamples, reversedPhaseTaps, numPhases, numTaps, sums);
+        }
+    }
+
+    void meterAvx2 (const float* input, int numSamples, const float* reversedPhaseTaps,
+                    int numPhases, int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        switch (numPhases)
+        {
+            case 1:  return meterAvx2Phases<1> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            case 2:  return meterAvx2Phases<2> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            case 3:  return meterAvx2Phases<3> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            default: return meterScalar (input, numSamples, reversedPhaseTaps, numPhases, numTaps, sums);
+        }
+    }
+
+    void meterAvx512 (const float* input, int numSamples, const float* reversedPhaseTaps,
+                      int numPhases, int numTaps, SimdKernels::MeterSums& sums) noexcept
+    {
+        switch (numPhases)
+        {
+            case 1:  return meterAvx512Phases<1> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            case 2:  return meterAvx512Phases<2> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            case 3:  return meterAvx512Phases<3> (input, numSamples, reversedPhaseTaps, numTaps, sums);
+            default: return meterScalar (input, numSamples, reversedPhaseTaps, numPhases, numTaps, sums);
+        }
+    }
+
+    //==============================================================================
+    // Split-complex layout keeps real and imaginary parts in separate lanes, so a
+    // complex multiply is four plain multiplies with no shuffles.
+    CAN_DAMONIUM_TARGET ("sse2")
+    void complexMacSse2 (const float* x, const float* h, float* acc, int numBins) noexcept
+    {
+        const auto* xIm = x + numBins;
+        const auto* hIm = h + numBins;
+        auto* accIm = acc + numBins;
+        int k = 0;
+
+        for (; k + 4 <= numBins; k += 4)
+        {
+            const auto xr = _mm_loadu_ps (x + k),   xi = _mm_loadu_ps (xIm + k);
+            const auto hr = _mm_loadu_ps (h + k),   hi = _mm_loadu_ps (hIm + k);
+
+            const auto re = _mm_sub_ps (_mm_mul_ps (xr, hr), _mm_mul_ps (xi, hi));
+            const auto im = _mm_add_ps (_mm_mul_ps (xr, hi), _mm_mul_ps (xi, hr));
+
+            _mm_storeu_ps (acc + k,   _mm_add_ps (_mm_loadu_ps (acc + k), re));
+            _mm_storeu_ps (accIm + k, _mm_add_ps (_mm_loadu_ps (accIm + k), im));
+        }
+
+        for (; k < numBins; ++k)
+        {
+            acc[k]   += x[k] * h[k] - xIm[k] * hIm[k];
+            accIm[k] += x[k] * hIm[k] + xIm[k] * h[k];
+        }
+    }
+
+    CAN_DAMONIUM_TARGET ("avx2,fma")
+    void complexMacAvx2 (const float* x, const float* h, float* acc, int numBins) noexcept
+    {
+        const auto* xIm = x + numBins;
+        const auto* hIm = h + numBins;
+        auto* accIm = acc + numBins;
+        int k = 0;
+
+        for (; k + 8 <= numBins; k += 8)
+        {
+            const auto xr = _mm256_loadu_ps (x + k),   xi = _mm256_loadu_ps (xIm + k);
+            const auto hr = _mm256_loadu_ps (h + k),   hi = _mm256_loadu_ps (hIm + k);
+
+            auto re = _mm256_fmadd_ps (xr, hr, _mm256_loadu_ps (acc + k));
+            auto im = _mm256_fmadd_ps (xr, hi, _mm256_loadu_ps (accIm + k));
+            re = _mm256_fnmadd_ps (xi, hi, re);
+            im = _mm256_fmadd_ps (xi, hr, im);
+
+            _mm256_storeu_ps (acc + k, re);
+            _mm256_storeu_ps (accIm + k, im);
+        }
+
+        for (; k < numBins; ++k)
+        {
+            acc[k]   += x[k] * h[k] - xIm[k] * hIm[k];
+            accIm[k] += x[k] * hIm[k] + xIm[k] * h[k];
+        }
+    }
+
+    CAN_DAMONIUM_TARGET ("avx512f")
+    void complexMacAvx512 (const float* x, const float* h, float* acc, int numBins) noexcept
+    {
+        const auto* xIm = x + numBins;
+        const auto* hIm = h + numBins;
+        auto* accIm = acc + numBins;
+        int k = 0;
+
+        for (; k + 16 <= numBins; k += 16)
+        {
+            const auto xr = _mm512_loadu_ps (x + k),   xi = _mm512_loadu_ps (xIm + k);
+            const auto hr = _mm512_loadu_ps (h + k),   hi = _mm512_loadu_ps (hIm + k);
+
+            auto re = _mm512_fmadd_ps (xr, hr, _mm512_loadu_ps (acc + k));
+            auto im = _mm512_fmadd_ps (xr, hi, _mm512_loadu_ps (accIm + k));
+            re = _mm512_fnmadd_ps (xi, hi, re);
+            im = _mm512_fmadd_ps (xi, hr, im);
+
+            _mm512_storeu_ps (acc + k, re);
+            _mm512_storeu_ps (accIm + k, im);
+        }
+
+        for (; k < numBins; ++k)
+        {
+            acc[k]   += x[k] * h[k] - xIm[k] * hIm[k];
+            accIm[k] += x[k] * hIm[k] + xIm[k] * h[k];
+        }
+    }
+   #endif
+}
+
+namespace SimdKernels
+{
+    KernelTable getKernels (InstructionSet instructionSet)
+    {
+       #if JUCE_INTEL
+        switch (instructionSet)
+        {
+            case InstructionSet::avx512: return { firAvx512, complexMacAvx512, dotProductAvx512, meterAvx512, "AVX-512" };
+            case InstructionSet::avx2:   return { firAvx2, complexMacAvx2,   dotProductAvx2, meterAvx2, "AVX2" };
+            case InstructionSet::sse2:   return { firSse2, complexMacSse2,   dotProductSse2, meterSse2, "SSE2" };
+            case InstructionSet::scalar: break;
+        }
+       #else
+        juce::ignoreUnused (instructionSet);
+       #endif
+
+        return { firScalar, complexMacScalar, dotProductScalar, meterScalar, "scalar" };
+    }
+
+    bool isSupported (InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+           #if JUCE_INTEL
+            case InstructionSet::avx512: return juce::SystemStats::hasAVX512F();
+            case InstructionSet::avx2:   return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+            case InstructionSet::sse2:   return juce::SystemStats::hasSSE2();
+           #else
+            case InstructionSet::avx512:
+            case InstructionSet::avx2:
+            case InstructionSet::sse2:   return false;
+           #endif
+            case InstructionSet::scalar: return true;
+        }
+
+        return false;
+    }
+
+    KernelTable selectKernels()
+    {
+        for (auto instructionSet : { InstructionSet::avx512, InstructionSet::avx2, InstructionSet::sse2 })
+            if (isSupported (instructionSet))
+                return getKernels (instructionSet);
+
+        return getKernels (InstructionSet::scalar);
+    }
+}
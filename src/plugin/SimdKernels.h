@@ -0,0 +1,66 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Hand-vectorised inner loops used by the convolution core, the IR resampler and the meters.
+ *
+ * Every kernel has a scalar version and one or more x86 versions. The widest
+ * variant the CPU supports is picked once at runtime, so the binary does not
+ * need to be compiled for a specific instruction set.
+ */
+namespace SimdKernels
+{
+    /** output[i] += sum over k of reversedTaps[k] * input[i + k], for i in [0, numSamples).
+        input must hold numSamples + numTaps - 1 samples. */
+    using FirFunction = void (*) (const float* reversedTaps, int numTaps,
+                                  const float* input, float* output, int numSamples) noexcept;
+
+    /** Split-complex multiply-accumulate: acc[k] += x[k] * h[k] for k in [0, numBins).
+        Spectra are stored as numBins real values followed by numBins imaginary values. */
+    using ComplexMacFunction = void (*) (const float* x, const float* h, float* acc, int numBins) noexcept;
+
+    /** Returns the sum over k of a[k] * b[k] for k in [0, numSamples). */
+    using DotProductFunction = float (*) (const float* a, const float* b, int numSamples) noexcept;
+
+    // Running levels of one channel; the meter kernel raises the maxima and adds to the sum
+    struct MeterSums
+    {
+        float peak = 0.0f;
+        float sumSquares = 0.0f;
+        float interpolatedPeak = 0.0f;
+    };
+
+    /** One pass over input[0, numSamples) for metering: the largest |input[i]|, the sum of squares, and
+        the largest |y| where y is every phase of an interpolator run as in fir. The numPhases phases of
+        numTaps reversed taps each read input[i - numTaps + 1] to input[i], so numTaps - 1 samples must
+        precede input. */
+    using MeterFunction = void (*) (const float* input, int numSamples, const float* reversedPhaseTaps,
+                                    int numPhases, int numTaps, MeterSums& sums) noexcept;
+
+    struct KernelTable
+    {
+        FirFunction fir = nullptr;
+        ComplexMacFunction complexMac = nullptr;
+        DotProductFunction dotProduct = nullptr;
+        MeterFunction meter = nullptr;
+        const char* name = "";
+    };
+
+    enum class InstructionSet
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    // Kernels for one instruction set (falls back to scalar if not compiled in)
+    KernelTable getKernels (InstructionSet instructionSet);
+
+    // True if this CPU can run the given instruction set
+    bool isSupported (InstructionSet instructionSet);
+
+    // Queries the CPU and returns the widest kernels it can run
+    KernelTable selectKernels();
+}
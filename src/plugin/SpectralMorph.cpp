@@ -0,0 +1,167 @@
+#include "SpectralMorph.h"
+
+namespace
+{
+    // Sine and cosine without branches or library calls, so the bin loop can vectorise.
+    // Reduced to a quarter turn in three steps (Cody-Waite), then Cephes polynomials;
+    // a few ulp of error up to the phases a long partition unwraps to.
+    inline void sinCos (float x, float& sine, float& cosine) noexcept
+    {
+        const float scaled = x * 0.636619772f;   // 2 / pi
+        const int quadrant = (int) (scaled + std::copysign (0.5f, scaled));
+        const float q = (float) quadrant;
+
+        float r = x - q * 1.5703125f;
+        r -= q * 4.837512969970703125e-4f;
+        r -= q * 7.54978995489188216e-8f;
+
+        const float r2 = r * r;
+        const float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        const float c = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+        // Odd quadrants swap sine and cosine; the signs follow the quadrant bits
+        const float swap = (float) (quadrant & 1);
+        sine = (1.0f - (float) (quadrant & 2)) * (s + swap * (c - s));
+        cosine = (1.0f - (float) ((quadrant + 1) & 2)) * (c + swap * (s - c));
+    }
+}
+
+//==============================================================================
+SpectralMorph::SpectralMorph (std::vector<std::shared_ptr<const PartitionedIR>> sourcesToUse, float initialPosition)
+    : sources (std::move (sourcesToUse))
+{
+    jassert (! sources.empty());
+    const auto& layout = sources.front()->getLayout();
+
+    spectra.assign (PartitionedIR::getSpectraSize (layout), 0.0f);
+    directHeadTaps.assign ((size_t) layout.directHeadLength, 0.0f);
+    output = std::make_unique<PartitionedIR> (layout, directHeadTaps.data(), spectra.data(), nullptr);
+
+    // Magnitude and phase of every bin, the phase unwrapped along each partition so it can be interpolated
+    for (const auto& source : sources)
+    {
+        jassert (source->getLayout().segments.size() == layout.segments.size());
+
+        std::vector<float> polar (spectra.size(), 0.0f);
+
+        for (size_t s = 0; s < layout.segments.size(); ++s)
+        {
+            const auto& segment = layout.segments[s];
+            const int numBins = PartitionedIR::getNumBins (segment.blockSize);
+
+            for (int p = 0; p < segment.numPartitions; ++p)
+            {
+                const auto* partition = source->getPartition ((int) s, p);
+                auto* magnitudes = polar.data() + (partition - source->getSpectra());
+                auto* phases = magnitudes + numBins;
+                float previous = 0.0f;
+
+                for (int k = 0; k <= segment.blockSize; ++k)
+                {
+                    const float re = partition[k];
+                    const float im = partition[numBins + k];
+                    float phase = std::atan2 (im, re);
+
+                    phase += juce::MathConstants<float>::twoPi
+                           * std::round ((previous - phase) / juce::MathConstants<float>::twoPi);
+
+                    magnitudes[k] = std::sqrt (re * re + im * im);
+                    phases[k] = previous = phase;
+                }
+            }
+        }
+
+        polarSpectra.push_back (std::move (polar));
+    }
+
+    targetPosition.store (juce::jlimit (0.0f, 1.0f, initialPosition));
+    directHeadPosition = -1.0f;
+    updateDirectHead();
+
+    for (size_t s = 0; s < layout.segments.size(); ++s)
+    {
+        const int numPartitions = layout.segments[s].numPartitions;
+
+        Sweep sweep;
+        sweep.position = targetPosition.load();
+        sweep.partitionsPerBlock = (numPartitions + blocksPerSweep - 1) / blocksPerSweep;
+        sweeps.push_back (sweep);
+
+        for (int p = 0; p < numPartitions; ++p)
+            renderPartition ((int) s, p, sweep.position);
+    }
+}
+
+void SpectralMorph::updateSegment (int segmentIndex) noexcept
+{
+    auto& sweep = sweeps[(size_t) segmentIndex];
+    const int numPartitions = output->getLayout().segments[(size_t) segmentIndex].numPartitions;
+    const float target = targetPosition.load (std::memory_order_relaxed);
+
+    // A move restarts the sweep from wherever it had got to
+    if (target != sweep.position)
+    {
+        sweep.position = target;
+        sweep.remaining = numPartitions;
+    }
+
+    const int numThisBlock = juce::jmin (sweep.remaining, sweep.partitionsPerBlock);
+
+    for (int i = 0; i < numThisBlock; ++i)
+    {
+        renderPartition (segmentIndex, sweep.nextPartition, sweep.position);
+        sweep.nextPartition = (sweep.nextPartition + 1) % numPartitions;
+    }
+
+    sweep.remaining -= numThisBlock;
+}
+
+void SpectralMorph::updateDirectHead() noexcept
+{
+    const float target = targetPosition.load (std::memory_order_relaxed);
+
+    if (target == directHeadPosition || directHeadTaps.empty())
+        return;
+
+    directHeadPosition = target;
+
+    const float scaled = target * (float) (sources.size() - 1);
+    const int lower = juce::jmin ((int) scaled, juce::jmax (0, (int) sources.size() - 2));
+    const int upper = juce::jmin (lower + 1, (int) sources.size() - 1);
+    const float amount = scaled - (float) lower;
+
+    const auto* a = sources[(size_t) lower]->getDirectHeadTaps();
+    const auto* b = sources[(size_t) upper]->getDirectHeadTaps();
+
+    for (size_t i = 0; i < directHeadTaps.size(); ++i)
+        directHeadTaps[i] = a[i] + amount * (b[i] - a[i]);
+}
+
+void SpectralMorph::renderPartition (int segmentIndex, int partition, float position) noexcept
+{
+    const float scaled = position * (float) (sources.size() - 1);
+    const int lower = juce::jmin ((int) scaled, juce::jmax (0, (int) sources.size() - 2));
+    const int upper = juce::jmin (lower + 1, (int) sources.size() - 1);
+    const float amount = scaled - (float) lower;
+
+    const int numBins = PartitionedIR::getNumBins (output->getLayout().segments[(size_t) segmentIndex].blockSize);
+    const auto offset = output->getPartition (segmentIndex, partition) - spectra.data();
+
+    const auto* magnitudesA = polarSpectra[(size_t) lower].data() + offset;
+    const auto* magnitudesB = polarSpectra[(size_t) upper].data() + offset;
+    const auto* phasesA = magnitudesA + numBins;
+    const auto* phasesB = magnitudesB + numBins;
+    auto* re = spectra.data() + offset;
+    auto* im = re + numBins;
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float magnitude = magnitudesA[k] + amount * (magnitudesB[k] - magnitudesA[k]);
+        const float phase = phasesA[k] + amount * (phasesB[k] - phasesA[k]);
+
+        float sine, cosine;
+        sinCos (phase, sine, cosine);
+        re[k] = magnitude * cosine;
+        im[k] = magnitude * sine;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "PartitionedConvolver.h"
+
+/**
+ * An impulse response interpolated between several partitioned IRs.
+ *
+ * Every source is kept as magnitude and phase, the phase unwrapped across the
+ * bins of each partition. The morphed IR interpolates both between the two
+ * sources either side of the position, so the response moves between them
+ * instead of cross-fading two outputs. The FIR head is interpolated in the
+ * time domain.
+ *
+ * The morphed spectra are rewritten a few partitions at a time by the segment
+ * that reads them, just before its multiply-accumulates, so a move costs a
+ * bounded amount per block and nothing while the position stands still.
+ */
+class SpectralMorph
+{
+public:
+    // All sources must share one layout. The morph starts out rendered at initialPosition.
+    SpectralMorph (std::vector<std::shared_ptr<const PartitionedIR>> sources, float initialPosition = 0.0f);
+
+    // Real-time safe. 0 is the first source, 1 the last; the others sit evenly in between.
+    void setPosition (float newPosition) noexcept { targetPosition.store (juce::jlimit (0.0f, 1.0f, newPosition)); }
+    float getPosition() const noexcept { return targetPosition.load(); }
+
+    // The IR the convolver reads; its contents change as segments are updated
+    const PartitionedIR& getOutput() const noexcept { return *output; }
+    int getNumSources() const noexcept { return (int) sources.size(); }
+
+    // Moves a segment's partitions towards the position. Only the thread running that segment may call this.
+    void updateSegment (int segmentIndex) noexcept;
+
+    // Moves the FIR head to the position; call from the thread running the head
+    void updateDirectHead() noexcept;
+
+    // A move takes this many blocks of each segment to reach every partition
+    static constexpr int blocksPerSweep = 4;
+
+private:
+    struct Sweep
+    {
+        float position = 0.0f;      // Position the partitions are being moved to
+        int nextPartition = 0;
+        int remaining = 0;          // Partitions still at an older position
+        int partitionsPerBlock = 1;
+    };
+
+    void renderPartition (int segmentIndex, int partition, float position) noexcept;
+
+    std::vector<std::shared_ptr<const PartitionedIR>> sources;
+    std::vector<std::vector<float>> polarSpectra;     // Per source: numBins magnitudes then numBins unwrapped phases
+    std::vector<float> spectra;
+    std::vector<float> directHeadTaps;
+    std::unique_ptr<PartitionedIR> output;
+
+    std::vector<Sweep> sweeps;
+    float directHeadPosition = 0.0f;
+    std::atomic<float> targetPosition { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectralMorph)
+};
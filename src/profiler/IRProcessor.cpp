@@ -21,27 +21,156 @@ bool IRProcessor::validateIR (const juce::File& irFile)
     return false;
 }
 
+std::vector<float> IRProcessor::computeEnergyDecayCurve (const juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (numSamples == 0)
+        return {};
+
+    std::vector<double> energy ((size_t) numSamples, 0.0);
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        auto* data = buffer.getReadPointer (ch);
+
+        for (int i = 0; i < numSamples; ++i)
+            energy[(size_t) i] += (double) data[i] * data[i];
+    }
+
+    auto meanEnergy = [&energy] (int start, int end)
+    {
+        double sum = 0.0;
+        for (int i = start; i < end; ++i)
+            sum += energy[(size_t) i];
+        return sum / juce::jmax (1, end - start);
+    };
+
+    // The last tenth is noise if it stays level; a tail that is still decaying is kept whole
+    const int noiseStart = numSamples - numSamples / 10;
+    const int noiseMiddle = (noiseStart + numSamples) / 2;
+    const double firstHalf = meanEnergy (noiseStart, noiseMiddle);
+    const double secondHalf = meanEnergy (noiseMiddle, numSamples);
+    const bool isNoiseFloor = numSamples >= 20 && secondHalf > 0.0 && firstHalf < 2.0 * secondHalf;
+    const double noiseEnergy = isNoiseFloor ? meanEnergy (noiseStart, numSamples) : 0.0;
+
+    // Stop at the first window after the peak that is within 3 dB of the noise
+    constexpr int windowLength = 512;
+    int end = numSamples;
+
+    if (isNoiseFloor)
+    {
+        const auto peak = (int) (std::max_element (energy.begin(), energy.end()) - energy.begin());
+
+        for (int start = peak; start + windowLength <= noiseStart; start += windowLength)
+        {
+            if (meanEnergy (start, start + windowLength) <= 2.0 * noiseEnergy)
+            {
+                end = start;
+                break;
+            }
+        }
+    }
+
+    std::vector<float> curve ((size_t) numSamples, -300.0f);
+    double remaining = 0.0;
+
+    for (int i = end - 1; i >= 0; --i)
+    {
+        remaining += energy[(size_t) i];
+        energy[(size_t) i] = remaining;
+    }
+
+    if (remaining <= 0.0)
+        return curve;
+
+    for (int i = 0; i < end; ++i)
+        curve[(size_t) i] = energy[(size_t) i] > 0.0 ? (float) (10.0 * std::log10 (energy[(size_t) i] / remaining)) : -300.0f;
+
+    return curve;
+}
+
 float IRProcessor::analyzeDecayEnvelope (const juce::AudioBuffer<float>& buffer)
 {
-    // TODO: Analyze envelope decay characteristics
-    return 0.0f;
+    const auto curve = computeEnergyDecayCurve (buffer);
+    const auto crossing = [&curve] (float level)
+    {
+        return (int) (std::find_if (curve.begin(), curve.end(), [level] (float value) { return value <= level; }) - curve.begin());
+    };
+
+    const int start = crossing (-5.0f);
+    const int end = crossing (-25.0f);
+
+    if (end >= (int) curve.size() || end <= start)
+        return 0.0f;
+
+    // 20 dB of decay took end - start samples; 60 dB takes three times as long
+    return 3.0f * (float) (end - start);
 }
 
 int IRProcessor::findTailEndSample (const juce::AudioBuffer<float>& buffer, float thresholdDb)
 {
-    auto* data = buffer.getReadPointer (0);
-    int numSamples = buffer.getNumSamples();
+    const auto curve = computeEnergyDecayCurve (buffer);
+    const auto end = std::find_if (curve.begin(), curve.end(), [thresholdDb] (float value) { return value < thresholdDb; });
+    return (int) (end - curve.begin());
+}
+
+void IRProcessor::convertToMinimumPhase (juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (numSamples < 2)
+        return;
 
-    float thresholdLinear = std::pow (10.0f, thresholdDb / 20.0f);
+    // Twice the IR length: the cepstrum of a decaying IR is small by the time the fold wraps it around,
+    // so the loud part of the spectrum stays within a few hundredths of a dB
+    const juce::dsp::FFT fft (juce::roundToInt (std::log2 (juce::nextPowerOfTwo (numSamples) * 2)));
+    const int size = fft.getSize();
+    std::vector<juce::dsp::Complex<float>> a ((size_t) size), b ((size_t) size);
 
-    // Search backwards from end for last sample above threshold
-    for (int i = numSamples - 1; i >= 0; --i)
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
     {
-        if (std::abs (data[i]) > thresholdLinear)
-            return i;
-    }
+        auto* data = buffer.getWritePointer (ch);
+
+        std::fill (a.begin(), a.end(), juce::dsp::Complex<float>());
+        for (int i = 0; i < numSamples; ++i)
+            a[(size_t) i] = data[i];
+
+        fft.perform (a.data(), b.data(), false);
+
+        // Log magnitude, floored 120 dB under the peak so nulls do not dominate the cepstrum
+        float peak = 0.0f;
+        for (const auto& bin : b)
+            peak = juce::jmax (peak, std::abs (bin));
+
+        if (peak <= 0.0f)
+            continue;
+
+        const float floor = peak * 1.0e-6f;
 
-    return 0;
+        for (auto& bin : b)
+            bin = std::log (juce::jmax (floor, std::abs (bin)));
+
+        fft.perform (b.data(), a.data(), true);
+
+        // Fold the real cepstrum onto positive quefrencies: the causal half of a minimum-phase log spectrum
+        for (int i = 1; i < size / 2; ++i)
+            a[(size_t) i] = 2.0f * a[(size_t) i].real();
+
+        a[0] = a[0].real();
+        a[(size_t) (size / 2)] = a[(size_t) (size / 2)].real();
+        std::fill (a.begin() + size / 2 + 1, a.end(), juce::dsp::Complex<float>());
+
+        fft.perform (a.data(), b.data(), false);
+
+        for (auto& bin : b)
+            bin = std::exp (bin);
+
+        fft.perform (b.data(), a.data(), true);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = a[(size_t) i].real();
+    }
 }
 
 void IRProcessor::normalizeBuffer (juce::AudioBuffer<float>& buffer, float targetDb)
@@ -63,10 +192,21 @@ void IRProcessor::normalizeBuffer (juce::AudioBuffer<float>& buffer, float targe
     }
 }
 
-void IRProcessor::trimBuffer (juce::AudioBuffer<float>& buffer, int endSample)
+void IRProcessor::trimBuffer (juce::AudioBuffer<float>& buffer, int endSample, int fadeLength)
 {
-    if (endSample < buffer.getNumSamples())
+    if (endSample >= buffer.getNumSamples())
+        return;
+
+    endSample = juce::jmax (0, endSample);
+    fadeLength = juce::jmin (fadeLength, endSample);
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
     {
-        buffer.setSize (buffer.getNumChannels(), endSample);
+        auto* data = buffer.getWritePointer (ch, endSample - fadeLength);
+
+        for (int i = 0; i < fadeLength; ++i)
+            data[i] *= 0.5f + 0.5f * std::cos (juce::MathConstants<float>::pi * (float) (i + 1) / (float) fadeLength);
     }
+
+    buffer.setSize (buffer.getNumChannels(), endSample, true);
 }
@@ -22,12 +22,28 @@ public:
     bool validateIR (const juce::File& irFile);
 
     // Analysis
-    float analyzeDecayEnvelope (const juce::AudioBuffer<float>& buffer);
-    int findTailEndSample (const juce::AudioBuffer<float>& buffer, float thresholdDb = -80.0f);
+    // Schroeder backward integral of the energy of all channels, in dB below the total.
+    // A flat noise floor at the end is detected and the integral stops where the decay
+    // meets it, so the noise does not hold the curve up.
+    static std::vector<float> computeEnergyDecayCurve (const juce::AudioBuffer<float>& buffer);
+
+    // Reverberation time in samples, extrapolated from the -5 to -25 dB slope of the decay curve (0 if it never gets there)
+    static float analyzeDecayEnvelope (const juce::AudioBuffer<float>& buffer);
+
+    // Sample count to keep: up to where the decay curve falls below thresholdDb, or meets the noise floor
+    static int findTailEndSample (const juce::AudioBuffer<float>& buffer, float thresholdDb = -80.0f);
+
+    // Processing
+    // Replaces every channel with the minimum-phase response of the same magnitude (real cepstrum method).
+    // The energy moves towards the start, so the IR can then be trimmed much shorter.
+    // Its FFTs are two to four times the IR length, so trim any silence or noise floor off first.
+    static void convertToMinimumPhase (juce::AudioBuffer<float>& buffer);
 
     // Utilities
     void normalizeBuffer (juce::AudioBuffer<float>& buffer, float targetDb = -3.0f);
-    void trimBuffer (juce::AudioBuffer<float>& buffer, int endSample);
+
+    // Shortens the buffer to endSample, fading the last fadeLength samples out with a half cosine
+    static void trimBuffer (juce::AudioBuffer<float>& buffer, int endSample, int fadeLength = 0);
 
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IRProcessor)
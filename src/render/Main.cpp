@@ -0,0 +1,284 @@
+#include <JuceHeader.h>
+#include "ConvolutionEngine.h"
+
+/**
+ * Convolves every input file with every IR through the plugin's ConvolutionEngine,
+ * running the offline algorithm and streaming each file in blocks from reader to writer.
+ * Files render in parallel, one engine per job.
+ *
+ * Usage: can_damonium_render --ir <file> [--ir <file> ...] [options] <input> [<input> ...]
+ *
+ *   --out <directory>   Where results go (default: ./rendered), named <input>_<ir>.wav
+ *   --jobs <n>          Files rendered at once (default: one per physical core)
+ *   --mix <0..1>        Wet proportion (default: 1)
+ *   --bits <16|24|32>   Output bit depth, 32 is float (default: 24)
+ *   --no-tail           Stop at the end of the input instead of letting the IR ring out
+ *   --verbose           Keep the engine's log output
+ */
+namespace
+{
+    constexpr int renderBlockSize = ConvolutionEngine::offlineBlockSize;
+    constexpr int numOutputChannels = 2;
+
+    struct Options
+    {
+        juce::Array<juce::File> inputs;
+        juce::Array<juce::File> irs;
+        juce::File outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile ("rendered");
+        int numJobs = juce::jmax (1, juce::SystemStats::getNumPhysicalCpus());
+        float mix = 1.0f;
+        int bitsPerSample = 24;
+        bool includeTail = true;
+        bool verbose = false;
+    };
+
+    struct Result
+    {
+        juce::File output;
+        juce::String error;             // Empty on success
+        juce::int64 numSamples = 0;
+        double seconds = 0.0;
+        float peak = 0.0f;
+    };
+
+    // The engine logs every load and prepare; a batch only wants the summary
+    class SilentLogger : public juce::Logger
+    {
+        void logMessage (const juce::String&) override {}
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: can_damonium_render --ir <file> [--ir <file> ...] [options] <input> [<input> ...]" << std::endl
+                  << "  --out <directory>   Where results go (default: ./rendered)" << std::endl
+                  << "  --jobs <n>          Files rendered at once (default: one per physical core)" << std::endl
+                  << "  --mix <0..1>        Wet proportion (default: 1)" << std::endl
+                  << "  --bits <16|24|32>   Output bit depth, 32 is float (default: 24)" << std::endl
+                  << "  --no-tail           Stop at the end of the input" << std::endl
+                  << "  --verbose           Keep the engine's log output" << std::endl;
+    }
+
+    bool parseArguments (const juce::StringArray& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--ir" && hasValue)            options.irs.add (juce::File::getCurrentWorkingDirectory().getChildFile (args[++i]));
+            else if (arg == "--out" && hasValue)      options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (args[++i]);
+            else if (arg == "--jobs" && hasValue)     options.numJobs = juce::jlimit (1, 64, args[++i].getIntValue());
+            else if (arg == "--mix" && hasValue)      options.mix = juce::jlimit (0.0f, 1.0f, args[++i].getFloatValue());
+            else if (arg == "--bits" && hasValue)     options.bitsPerSample = args[++i].getIntValue();
+            else if (arg == "--no-tail")              options.includeTail = false;
+            else if (arg == "--verbose")              options.verbose = true;
+            else if (arg.startsWith ("--"))
+            {
+                std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+                return false;
+            }
+            else
+            {
+                options.inputs.add (juce::File::getCurrentWorkingDirectory().getChildFile (arg));
+            }
+        }
+
+        if (options.bitsPerSample != 16 && options.bitsPerSample != 24 && options.bitsPerSample != 32)
+        {
+            std::cerr << "Bit depth must be 16, 24 or 32" << std::endl;
+            return false;
+        }
+
+        for (const auto& file : options.irs)
+        {
+            if (! file.existsAsFile())
+            {
+                std::cerr << "IR not found: " << file.getFullPathName() << std::endl;
+                return false;
+            }
+        }
+
+        return ! options.inputs.isEmpty() && ! options.irs.isEmpty();
+    }
+
+    Result render (const juce::File& input, const juce::File& ir, const juce::File& output,
+                   const Options& options, juce::AudioFormatManager& formatManager, bool useEngineThreads)
+    {
+        Result result;
+        result.output = output;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (input));
+
+        if (reader == nullptr)
+        {
+            result.error = "unreadable input";
+            return result;
+        }
+
+        const int numInputChannels = (int) juce::jlimit (1u, 2u, reader->numChannels);
+
+        ConvolutionEngine engine;
+        engine.setIrResampleEnabled (true);
+        engine.setResamplerQuality (PolyphaseResampler::Quality::best);    // A bounce can afford the longest filter
+        engine.setOfflineMultithreaded (useEngineThreads);
+        engine.setMix (options.mix);
+        engine.prepareToPlay (reader->sampleRate, renderBlockSize, ConvolutionEngine::Algorithm::offline, numInputChannels);
+
+        auto load = engine.loadImpulseResponseAsync (ir);
+        while (! load->isDone())
+            juce::Thread::sleep (5);
+
+        if (load->getState() != IRLoadHandle::State::finished)
+        {
+            result.error = "IR load failed: " + load->getErrorMessage();
+            return result;
+        }
+
+        output.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream (output.createOutputStream().release());
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (stream != nullptr)
+            writer = wav.createWriterFor (stream, juce::AudioFormatWriterOptions()
+                                                      .withSampleRate (reader->sampleRate)
+                                                      .withNumChannels (numOutputChannels)
+                                                      .withBitsPerSample (options.bitsPerSample)
+                                                      .withSampleFormat (options.bitsPerSample == 32
+                                                                             ? juce::AudioFormatWriterOptions::SampleFormat::floatingPoint
+                                                                             : juce::AudioFormatWriterOptions::SampleFormat::integral));
+
+        if (writer == nullptr)
+        {
+            result.error = "cannot write output";
+            return result;
+        }
+
+        // The first latency samples out of the engine come before the input; the tail follows it
+        const int latency = engine.getLatencySamples();
+        const auto tailSamples = options.includeTail
+            ? juce::jmax ((juce::int64) 0, (juce::int64) std::ceil (engine.getTailLengthSeconds() * reader->sampleRate) - latency)
+            : (juce::int64) 0;
+        const auto totalSamples = reader->lengthInSamples + tailSamples;
+
+        juce::AudioBuffer<float> buffer (numOutputChannels, renderBlockSize);
+        juce::int64 readPosition = 0;
+        juce::int64 toSkip = latency;
+
+        while (result.numSamples < totalSamples)
+        {
+            const int numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) renderBlockSize, reader->lengthInSamples - readPosition);
+            buffer.clear();
+
+            if (numToRead > 0)
+                reader->read (&buffer, 0, numToRead, readPosition, true, numInputChannels > 1);
+
+            readPosition += numToRead;
+
+            // The engine reads the first channel only when prepared for a mono input
+            if (numInputChannels == 1)
+                buffer.copyFrom (1, 0, buffer, 0, 0, renderBlockSize);
+
+            engine.processBlock (buffer);
+
+            const int start = (int) juce::jmin (toSkip, (juce::int64) renderBlockSize);
+            const int numToWrite = (int) juce::jmin ((juce::int64) (renderBlockSize - start), totalSamples - result.numSamples);
+            toSkip -= start;
+
+            if (numToWrite > 0)
+            {
+                for (int ch = 0; ch < numOutputChannels; ++ch)
+                    result.peak = juce::jmax (result.peak, buffer.getMagnitude (ch, start, numToWrite));
+
+                if (! writer->writeFromAudioSampleBuffer (buffer, start, numToWrite))
+                {
+                    result.error = "write failed";
+                    return result;
+                }
+
+                result.numSamples += numToWrite;
+            }
+        }
+
+        result.seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+        return result;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    Options options;
+
+    if (! parseArguments (juce::StringArray (argv + 1, argc - 1), options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    SilentLogger silentLogger;
+    if (! options.verbose)
+        juce::Logger::setCurrentLogger (&silentLogger);
+
+    if (! options.outputDirectory.createDirectory())
+    {
+        std::cerr << "Cannot create " << options.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // With several files at once the cores are already busy, so each engine keeps to its own thread
+    const int numRenders = options.inputs.size() * options.irs.size();
+    const int numJobs = juce::jmin (options.numJobs, numRenders);
+    const bool useEngineThreads = numJobs == 1;
+
+    std::cout << "Rendering " << options.inputs.size() << " file(s) through " << options.irs.size()
+              << " IR(s), " << numJobs << " at a time" << std::endl;
+
+    juce::ThreadPool pool (numJobs);
+    juce::CriticalSection outputLock;
+    std::atomic<int> numFailed { 0 };
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    // Grouped by IR, so jobs running together share its partitions through the IR cache
+    for (const auto& ir : options.irs)
+    {
+        for (const auto& input : options.inputs)
+        {
+            const auto output = options.outputDirectory.getChildFile (input.getFileNameWithoutExtension() + "_"
+                                                                      + ir.getFileNameWithoutExtension() + ".wav");
+
+            pool.addJob ([&, input, ir, output]
+            {
+                const auto result = render (input, ir, output, options, formatManager, useEngineThreads);
+                const juce::ScopedLock sl (outputLock);
+
+                if (result.error.isNotEmpty())
+                {
+                    ++numFailed;
+                    std::cerr << "FAILED " << input.getFileName() << " x " << ir.getFileName() << ": " << result.error << std::endl;
+                    return;
+                }
+
+                std::cout << "  " << output.getFileName() << "  " << juce::String (result.seconds, 2) << " s"
+                          << "  peak " << juce::String (juce::Decibels::gainToDecibels (result.peak), 1) << " dBFS"
+                          << (result.peak > 1.0f && options.bitsPerSample < 32 ? "  (clipped)" : "") << std::endl;
+            });
+        }
+    }
+
+    while (pool.getNumJobs() > 0)
+        juce::Thread::sleep (20);
+
+    const double seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    std::cout << "Done in " << juce::String (seconds, 2) << " s";
+
+    if (numFailed > 0)
+        std::cout << ", " << numFailed.load() << " failed";
+
+    std::cout << std::endl;
+    juce::Logger::setCurrentLogger (nullptr);
+    return numFailed > 0 ? 1 : 0;
+}